@@ -5,6 +5,18 @@
 #include "shader.h"
 #include "camera.h"
 #include "cylinder.h"
+#include "proceduralMeshCache.h"
+#include "instancedBatch.h"
+#include "geometryArena.h"
+#include "frameUniforms.h"
+#include "glStateCache.h"
+#include "renderQueue.h"
+#include "indirectDrawList.h"
+#include "textureLoader.h"
+#include "cookedTexture.h"
+#include "materialAtlas.h"
+#include "transformSystem.h"
+#include "frustum.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -15,12 +27,17 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+int cookTextures(int numPaths, char* paths[]);
 
 //Window settings
 const unsigned int SCR_WIDTH = 800;
@@ -45,7 +62,12 @@ float lastFrame = 0.0f;
 
 
 
-int main() {
+int main(int argc, char* argv[]) {
+
+	//Rebuilds texture caches and exits, e.g. Project --cook-textures [images...]
+	if (argc > 1 && std::string(argv[1]) == "--cook-textures") {
+		return cookTextures(argc - 2, argv + 2);
+	}
 	
 	//instantiates the GLFW window
 	glfwInit();
@@ -82,16 +104,27 @@ int main() {
 	//Configures global opengl state
 	glEnable(GL_DEPTH_TEST);
 
+	//All binds go through the state cache, so that redundant ones are skipped
+	GLStateCache& glState = GLStateCache::getInstance();
+
 	//Building and compiling our shader program
 	Shader ourShader("shaderfiles/7.3.camera.vs", "shaderfiles/7.3.camera.fs");
-	Shader lightCubeShader("shaderfiles/2.2.light_cube.vs", "shaderfiles/2.2.light_cube.fs");
+	Shader lightCubeShader("shaderfiles/2.2.light_cube_instanced.vs", "shaderfiles/2.2.light_cube.fs");
+	Shader staticShader("shaderfiles/7.3.camera_indirect.vs", "shaderfiles/7.3.camera_atlas.fs");
+
+	//Projection, view and camera data are shared by all programs through one uniform buffer
+	FrameUniforms frameUniforms;
+	frameUniforms.createUBO();
+	ourShader.bindUniformBlock(FrameUniforms::BLOCK_NAME, FrameUniforms::BINDING_POINT);
+	lightCubeShader.bindUniformBlock(FrameUniforms::BLOCK_NAME, FrameUniforms::BINDING_POINT);
+	staticShader.bindUniformBlock(FrameUniforms::BLOCK_NAME, FrameUniforms::BINDING_POINT);
 
 
 
 	//Configure light cube VAO and VBO
 	unsigned int lightCubeVAO;
 	glGenVertexArrays(1, &lightCubeVAO);
-	glBindVertexArray(lightCubeVAO);
+	glState.bindVertexArray(lightCubeVAO);
 
 	//Vertices for the shape
 	float vertices[] = {
@@ -178,273 +211,30 @@ int main() {
 	};
 
 
-	//Generating a Vertex Buffer Object and Vertex Attribut object, then binding it
-	unsigned int VBO, VAO;
-	unsigned int cubeVBO, cubeVAO;
-	unsigned int cylinderVBO, cylinderVAO;
-	unsigned int cylinderVBO2, cylinderVAO2;
-	unsigned int bookVBO, bookVAO;
-	unsigned int pyrVBO, pyrVAO;
-
-	//Plane------------------------------------------
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	//Bind the vertex array
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	//Calls the buffer data(type of buffer to copy data into, size of data, actual data we want to send, how the graphics card uses the data)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-
-	//Position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	//Texture Coord attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	//--------------------------------------------------
-	//Cube object(bottle)
-	glGenVertexArrays(1, &cubeVAO);
-	glGenBuffers(1, &cubeVBO);
-	glBindVertexArray(cubeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	//Position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	//Texture Coord attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	//All static geometry lives in one arena: a single VBO and VAO, every shape is a range of vertices in it
+	static_meshes_3D::GeometryArena staticGeometry(sizeof(vertices) / sizeof(float) / static_meshes_3D::GeometryArena::FLOATS_PER_VERTEX);
 
-	//-----------------------------------------------
-	//Cube object(book)
-	glGenVertexArrays(1, &bookVAO);
-	glGenBuffers(1, &bookVBO);
-	glBindVertexArray(bookVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, bookVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	//Position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	//Texture Coord attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	//------------------------------------------------
-	//cylinder object(bottle cap)
-	glGenVertexArrays(1, &cylinderVAO);
-	glGenBuffers(1, &cylinderVBO);
-	glBindVertexArray(cylinderVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
-
-	//------------------------------------------------
-	//cylinder object(speaker)
-	glGenVertexArrays(1, &cylinderVAO2);
-	glGenBuffers(1, &cylinderVBO2);
-	glBindVertexArray(cylinderVAO2);
-	glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO2);
-
-	//--------------------------------------------------
-	//Pyramid container
-	glGenVertexArrays(1, &pyrVAO);
-	glGenBuffers(1, &pyrVBO);
-	glBindVertexArray(pyrVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, pyrVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	//Position and texture
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	//Cube (bottle and book), plane and pyramid container
+	const auto cubeGeometry = staticGeometry.addGeometry(vertices, 36);
+	const auto planeGeometry = staticGeometry.addGeometry(vertices + 36 * static_meshes_3D::GeometryArena::FLOATS_PER_VERTEX, 6);
+	const auto pyramidGeometry = staticGeometry.addGeometry(vertices + 42 * static_meshes_3D::GeometryArena::FLOATS_PER_VERTEX, 18);
+	staticGeometry.uploadToGPU();
 
 	//-----------------------------------------------------
 
-	//Load and create texture
-	unsigned int texture, texture2, texture3, texture4, texture5, texture6, texture7;
-
-	//First texture
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); //flips the texture
-	unsigned char* data = stbi_load("Background.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-	
-	//second texture
-	//Load and create texture
-	glGenTextures(1, &texture2);
-	glBindTexture(GL_TEXTURE_2D, texture2);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data2 = stbi_load("polish-bottle.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data2);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data2);
-
-	//Third texture
-	//Load and create texture
-	glGenTextures(1, &texture3);
-	glBindTexture(GL_TEXTURE_2D, texture3);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data3 = stbi_load("bottle-cap.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data3);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data3);
-
-	//Fourth texture
-	//Load and create texture
-	glGenTextures(1, &texture4);
-	glBindTexture(GL_TEXTURE_2D, texture4);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data4 = stbi_load("speaker.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data4);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data4);
-
-	//Fifth texture
-	//Load and create texture
-	glGenTextures(1, &texture5);
-	glBindTexture(GL_TEXTURE_2D, texture5);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data5 = stbi_load("brown-leather.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data5);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data5);
-
-	//Sixth texture
-	//Load and create texture
-	glGenTextures(1, &texture6);
-	glBindTexture(GL_TEXTURE_2D, texture6);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data6 = stbi_load("book.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data6);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data6);
-
-	//Seventh texture
-	//Load and create texture
-	glGenTextures(1, &texture7);
-	glBindTexture(GL_TEXTURE_2D, texture7);
-
-	//Sets the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	//Textures are decoded in parallel on worker threads and uploaded as they arrive,
+	//until then every texture shows a 1x1 placeholder
+	TextureLoader textureLoader;
+	unsigned int texture3 = textureLoader.requestTexture("bottle-cap.jpg");
+	unsigned int texture4 = textureLoader.requestTexture("speaker.jpg");
 
-	//Sets the texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	//Loads the image, create texture, and generates mipmaps
-	unsigned char* data7 = stbi_load("red-checker.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data7);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failure to load texture" << std::endl;
-	}
-	stbi_image_free(data7);
+	//Materials of static props share one texture array, so they are drawn without texture switches
+	MaterialAtlas materialAtlas;
+	const int backgroundMaterial = materialAtlas.addMaterial("Background.jpg");
+	const int polishBottleMaterial = materialAtlas.addMaterial("polish-bottle.jpg");
+	const int leatherMaterial = materialAtlas.addMaterial("brown-leather.jpg");
+	const int checkerMaterial = materialAtlas.addMaterial("red-checker.jpg");
+	materialAtlas.build(textureLoader);
 
 	ourShader.use();
 	ourShader.setInt("texture", 0);
@@ -454,10 +244,98 @@ int main() {
 	ourShader.setInt("texture5", 4);
 	ourShader.setInt("texture6", 5);
 	ourShader.setInt("texture7", 6);
-	
 
-	glm::mat4 model;
-	float angle;
+	staticShader.use();
+	staticShader.setInt("atlas", 0);
+
+	RenderQueue renderQueue;
+
+	//Placement of all objects as a scene graph, world matrices are recomputed only when a transform or one of its parents changes
+	TransformSystem transforms;
+	const auto noRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	const auto yawTilt = glm::angleAxis(glm::radians(-15.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	//Desk carries the background plane, the book and the polish bottle
+	const auto deskTransform = transforms.createTransform(glm::vec3(0.0f, -5.0f, 0.0f));
+	const auto planeTransform = transforms.createTransform(glm::vec3(0.0f), glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+		glm::vec3(7.0f, 5.0f, 7.0f));
+	transforms.setParent(planeTransform, deskTransform);
+	const auto bookTransform = transforms.createTransform(glm::vec3(-0.59008f, 2.75f, 1.91244f), yawTilt, glm::vec3(1.5f, 0.5f, 2.0f));
+	transforms.setParent(bookTransform, deskTransform);
+
+	//Bottle is not scaled itself, so its cap does not inherit the scale of the glass
+	const auto bottleTransform = transforms.createTransform(glm::vec3(1.2f, 2.75f, 0.0f), yawTilt);
+	transforms.setParent(bottleTransform, deskTransform);
+	const auto cubeTransform = transforms.createTransform(glm::vec3(0.0f), noRotation, glm::vec3(0.4f, 0.5f, 0.3f));
+	transforms.setParent(cubeTransform, bottleTransform);
+	const auto capTransform = transforms.createTransform(glm::vec3(-0.012074f, 0.25f, 0.003235f), noRotation, glm::vec3(0.25f, 0.5f, 0.25f));
+	transforms.setParent(capTransform, bottleTransform);
+
+	const auto pyramidTransform = transforms.createTransform(glm::vec3(-1.25f, -1.25f, -2.0f), noRotation, glm::vec3(2.5f, 2.5f, 1.0f));
+	const auto speakerTransform = transforms.createTransform(glm::vec3(0.0f, -1.875f, -0.6f), noRotation, glm::vec3(0.4f, 1.25f, 0.4f));
+	const auto lightTransform = transforms.createTransform(lightPos, noRotation, glm::vec3(0.2f));
+	const auto light2Transform = transforms.createTransform(lightPos2, noRotation, glm::vec3(0.2f));
+	transforms.update();
+
+	//Static props never move, so their draws are recorded once and submitted with multi-draw indirect
+	static_meshes_3D::IndirectDrawList staticDraws(staticGeometry, materialAtlas);
+	const auto staticOutput = transforms.createOutput();
+
+	//CUBE---------------------------------------
+	transforms.setOutput(cubeTransform, staticOutput,
+		staticDraws.addDraw(cubeGeometry, transforms.getWorldMatrix(cubeTransform), polishBottleMaterial));
+	//--------------------------------------------
+
+	//book---------------------------------------
+	//Base texture of brown leather
+	//glActiveTexture(GL_TEXTURE1);			//overlap texture of the book title.
+	//glBindTexture(GL_TEXTURE_2D, texture6);
+	transforms.setOutput(bookTransform, staticOutput,
+		staticDraws.addDraw(cubeGeometry, transforms.getWorldMatrix(bookTransform), leatherMaterial));
+	//--------------------------------------------
+
+	//PLANE---------------------------------------
+	transforms.setOutput(planeTransform, staticOutput,
+		staticDraws.addDraw(planeGeometry, transforms.getWorldMatrix(planeTransform), backgroundMaterial));
+	//-----------------------------------------------
+	
+	//Pyramid container
+	transforms.setOutput(pyramidTransform, staticOutput,
+		staticDraws.addDraw(pyramidGeometry, transforms.getWorldMatrix(pyramidTransform), checkerMaterial));
+	//----------------------------------------------------------
+
+	staticDraws.uploadToGPU();
+	const int staticDrawTransforms[] = { cubeTransform, bookTransform, planeTransform, pyramidTransform };
+
+	//Bounds of the static geometry in local space, objects outside of the view are not drawn
+	transforms.setLocalBounds(cubeTransform, cubeGeometry.bounds);
+	transforms.setLocalBounds(bookTransform, cubeGeometry.bounds);
+	transforms.setLocalBounds(planeTransform, planeGeometry.bounds);
+	transforms.setLocalBounds(pyramidTransform, pyramidGeometry.bounds);
+
+	//Procedural meshes are generated once here and shared by the render loop
+	//Planar layout, tools/vertex_fetch_bench.cpp did not measure faster vertex fetch with the interleaved one
+	const auto layout = static_meshes_3D::VertexLayout::Planar;
+	static_meshes_3D::ProceduralMeshCache meshCache;
+	auto bottleCapMesh = meshCache.getIndexedCylinder(0.25, 20, 1, true, true, true, layout);
+	auto speakerMesh = meshCache.getIndexedCylinder(2, 20, 1, true, true, true, layout);
+	auto lightMesh = meshCache.getIndexedCylinder(1, 30, 1.5, true, true, true, layout);
+	transforms.setLocalBounds(capTransform, bottleCapMesh->getBounds());
+	transforms.setLocalBounds(speakerTransform, speakerMesh->getBounds());
+
+	Frustum frustum;
+	std::vector<uint8_t> isTransformVisible;
+
+	//Objects, that can be picked by clicking at them (center of the screen, the cursor is captured)
+	const std::pair<int, const char*> pickableObjects[] = { { cubeTransform, "polish bottle" }, { bookTransform, "book" },
+		{ planeTransform, "background" }, { pyramidTransform, "pyramid container" }, { capTransform, "bottle cap" }, { speakerTransform, "speaker" } };
+	bool wasPickPressed = false;
+
+	//Both light sources share one mesh, so they are rendered as instances of it
+	static_meshes_3D::InstancedBatch lightBatch(lightMesh);
+	const auto lightOutput = transforms.createOutput();
+	transforms.setOutput(lightTransform, lightOutput, lightBatch.addInstance(transforms.getWorldMatrix(lightTransform)));
+	transforms.setOutput(light2Transform, lightOutput, lightBatch.addInstance(transforms.getWorldMatrix(light2Transform)));
 
 	//Render loop: will keep running until told to stop
 	while (!glfwWindowShouldClose(window)) {
@@ -470,10 +348,47 @@ int main() {
 		//Input
 		processInput(window);
 
+		//Uploads textures, that finished decoding since the last frame
+		textureLoader.pump();
+
 		lightPos[0] = xlight;
 		lightPos[1] = ylight;
 		lightPos[2] = zlight;
+		transforms.setPosition(lightTransform, lightPos);
+
+		//Only changed matrices are recomputed and written to the instance buffers
+		transforms.update();
+		size_t matrixStride;
+		if (transforms.isOutputDirty(staticOutput))
+		{
+			if (auto matrices = staticDraws.mapModelMatrices(matrixStride))
+			{
+				transforms.writeOutput(staticOutput, matrices, matrixStride);
+				staticDraws.unmapModelMatrices();
+			}
+		}
+		if (transforms.isOutputDirty(lightOutput))
+		{
+			if (auto matrices = lightBatch.mapModelMatrices(matrixStride))
+			{
+				transforms.writeOutput(lightOutput, matrices, matrixStride);
+				lightBatch.unmapModelMatrices();
+			}
+		}
 
+		//Picking shoots a ray from the camera through the hierarchy of object bounds
+		const auto isPickPressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+		if (isPickPressed && !wasPickPressed) {
+
+			float pickDistance;
+			const auto picked = transforms.pick(camera.Position, camera.Front, 100.0f, &pickDistance);
+			for (const auto& object : pickableObjects) {
+				if (object.first == picked) {
+					std::cout << "Picked " << object.second << " at distance " << pickDistance << std::endl;
+				}
+			}
+		}
+		wasPickPressed = isPickPressed;
 
 		//Render commands go here
 		
@@ -483,9 +398,6 @@ int main() {
 		
 		
 
-		//Activates shader
-		ourShader.use();
-
 		//Passes the projection matrix to shader
 		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
 
@@ -507,141 +419,49 @@ int main() {
 
 		}*/
 
-		ourShader.setMat4("projection", projection);
-
-
 		//Camera/view transformation
 		glm::mat4 view = camera.GetViewMatrix();
-		ourShader.setMat4("view", view);
-
-		//CUBE---------------------------------------
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-		glBindVertexArray(cubeVAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(0.4, 0.5, 0.3));
-		model = glm::translate(model, glm::vec3(3.0f, -4.5f, 0.0f));
-		model = glm::rotate(model, glm::radians(-15.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		ourShader.setMat4("model", model);
-		
-		//Draws the shape
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-		//--------------------------------------------
-
-		//book---------------------------------------
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);			//Base texture of brown leather
-		glBindTexture(GL_TEXTURE_2D, texture5);
-		//glActiveTexture(GL_TEXTURE1);			//overlap texture of the book title.
-		//glBindTexture(GL_TEXTURE_2D, texture6);
-		glBindVertexArray(bookVAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::rotate(model, glm::radians(-15.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(1.5, 0.5, 2.0));
-		model = glm::translate(model, glm::vec3(-0.05f, -4.5f, 1.0f));
-		ourShader.setMat4("model", model);
-
-		//Draws the shape
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-		//--------------------------------------------
-
-		//PLANE---------------------------------------
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glBindVertexArray(VAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(7.0, 5.0, 7.0));
-		model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		ourShader.setMat4("model", model);
-
-		//Draws the shape
-		glDrawArrays(GL_TRIANGLES, 36, 6);
-		//-----------------------------------------------
-		
+
+		//Uploads camera data once for all programs
+		frameUniforms.update(projection, view, camera.Position, currentFrame);
+
+		//Culls everything against the view frustum, hidden static props stay in the multi-draw with zero instances
+		frustum.setFromMatrix(projection * view);
+		transforms.cull(frustum, isTransformVisible);
+		for (int i = 0; i < staticDraws.getNumDraws(); i++) {
+			staticDraws.setDrawVisible(i, isTransformVisible[staticDrawTransforms[i]] != 0);
+		}
+
+		//All static props in one multi-draw call
+		staticShader.use();
+		staticDraws.render();
+
+		//Remaining objects are collected first and drawn in state-sorted order
+		renderQueue.begin(camera.Position, 100.0f);
+
 		//CYLINDER---------------------------------------
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture3);
-		glBindVertexArray(VAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(0.25, 0.5, 0.25));
-		model = glm::translate(model, glm::vec3(4.75f, -4.0f, 0.0f));
-		model = glm::rotate(model, glm::radians(-15.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		ourShader.setMat4("model", model);
-
-		static_meshes_3D::Cylinder C(0.25, 20, 1, true, true, true);
-		C.render();
+		if (isTransformVisible[capTransform]) {
+			renderQueue.submit(ourShader, texture3, *bottleCapMesh, transforms.getWorldMatrix(capTransform));
+		}
 
 		//-------------------------------------------------
 
 		//CYLINDER2---------------------------------------
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture4);
-		glBindVertexArray(VAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(0.4, 1.25, 0.4));
-		model = glm::translate(model, glm::vec3(0.0f, -1.5f, -1.5f));
-		model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		ourShader.setMat4("model", model);
-
-		static_meshes_3D::Cylinder C2(2, 20, 1, true, true, true);
-		C2.render();
+		if (isTransformVisible[speakerTransform]) {
+			renderQueue.submit(ourShader, texture4, *speakerMesh, transforms.getWorldMatrix(speakerTransform));
+		}
 		//----------------------------------------------------
 
-		//Pyramid container
-		//Renders the shape
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture7);
-		glBindVertexArray(pyrVAO);
-		//Creates transformations
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(2.5, 2.5, 1.0));
-		model = glm::translate(model, glm::vec3(-0.5f, -0.5f, -2.0f));
-		model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
-		ourShader.setMat4("model", model);
-
-		//Draws the shape
-		glDrawArrays(GL_TRIANGLES, 42, 18);
-		//----------------------------------------------------------
-
-		//Light cube
-		lightCubeShader.use();
-		lightCubeShader.setMat4("projection", projection);
-		lightCubeShader.setMat4("view", view);
-		
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos);
-		model = glm::scale(model, glm::vec3(0.2f)); 
-		lightCubeShader.setMat4("model", model);
-
-		static_meshes_3D::Cylinder C3(1, 30, 1.5, true, true, true);
-		C3.render();
-
-		glBindVertexArray(lightCubeVAO);
+		//Draws collected objects sorted by state and depth
+		renderQueue.flush();
 
-		//Second light source
+		//Light sources
 		lightCubeShader.use();
-		lightCubeShader.setMat4("projection", projection);
-		lightCubeShader.setMat4("view", view);
 
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos2);
-		model = glm::scale(model, glm::vec3(0.2f));
-		lightCubeShader.setMat4("model", model);
+		//Both lights in one draw call
+		lightBatch.render();
 
-		static_meshes_3D::Cylinder C4(1, 30, 1.5, true, true, true);
-		C4.render();
-
-		glBindVertexArray(lightCubeVAO);
+		glState.bindVertexArray(lightCubeVAO);
 
 		//Swaps buffers and poll IO events
 		glfwSwapBuffers(window);
@@ -649,23 +469,28 @@ int main() {
 	}
 
 	//De-allocates resources
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
-
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
-
-	glDeleteVertexArrays(1, &cylinderVAO);
-	glDeleteBuffers(1, &cylinderVBO);
-
-	glDeleteVertexArrays(1, &cylinderVAO2);
-	glDeleteBuffers(1, &cylinderVBO2);
-
-	glDeleteVertexArrays(1, &bookVAO);
-	glDeleteBuffers(1, &bookVBO);
-	
-	glDeleteVertexArrays(1, &pyrVAO);
-	glDeleteBuffers(1, &pyrVBO);
+	staticDraws.deleteList();
+	textureLoader.deleteTextures();
+	materialAtlas.deleteAtlas();
+	staticGeometry.deleteArena();
+	frameUniforms.deleteUBO();
+
+	//Procedural meshes must be released before the context goes away
+	lightBatch.deleteBatch();
+	bottleCapMesh.reset();
+	speakerMesh.reset();
+	lightMesh.reset();
+	meshCache.clear();
+
+	const auto& glCounters = glState.getCounters();
+	std::cout << "GL state changes issued: " << glCounters.issued << ", skipped: " << glCounters.skipped << std::endl;
+	const auto& cullCounters = frustum.getCounters();
+	std::cout << "Objects visible: " << cullCounters.visible << ", culled: " << cullCounters.culled << std::endl;
+	for (const auto& timing : textureLoader.getUploadRing().getUploadTimings()) {
+		std::cout << "Texture upload " << timing.numBytes << " bytes" << (timing.isStreamed ? "" : " (not streamed)")
+			<< ": wait " << timing.waitMilliseconds << " ms, copy " << timing.copyMilliseconds
+			<< " ms, submit " << timing.submitMilliseconds << " ms" << std::endl;
+	}
 
 	//Cleans up the glfw resources
 	glfwTerminate();
@@ -708,6 +533,34 @@ void processInput(GLFWwindow *window) {
 		orthographic = !orthographic;
 }
 
+//Cooks caches of given images, or of all scene textures, when no image is given
+int cookTextures(int numPaths, char* paths[]) {
+
+	static const char* sceneTextures[] = { "Background.jpg", "polish-bottle.jpg", "bottle-cap.jpg", "speaker.jpg",
+		"brown-leather.jpg", "book.jpg", "red-checker.jpg" };
+	std::vector<std::string> sources;
+	if (numPaths > 0) {
+		sources.assign(paths, paths + numPaths);
+	}
+	else {
+		sources.assign(std::begin(sceneTextures), std::end(sceneTextures));
+	}
+
+	int numFailed = 0;
+	for (const auto& source : sources) {
+
+		CookedTexture cookedTexture;
+		if (cookedTexture.loadOrCook(source, true, true)) {
+			std::cout << "Cooked " << CookedTexture::getCachePath(source) << " (" << cookedTexture.getLevels().size() << " levels)" << std::endl;
+		}
+		else {
+			std::cout << "Failure to cook " << source << std::endl;
+			numFailed++;
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
 //function called whenever the window is resized
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 
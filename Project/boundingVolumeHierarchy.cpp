@@ -0,0 +1,508 @@
+// STL
+#include <algorithm>
+#include <cfloat>
+#include <future>
+#include <thread>
+
+// Project
+#include "boundingVolumeHierarchy.h"
+#include "frustum.h"
+
+namespace {
+
+	// Cost of visiting a node relative to testing one object, used by the surface area heuristic
+	const float TRAVERSAL_COST = 1.0f;
+
+	struct FrustumStackEntry
+	{
+		int node;
+		bool isInside; // Node lies completely inside the frustum, its objects need no more tests
+	};
+
+} // namespace
+
+void BoundingVolumeHierarchy::build(const std::vector<BoundingBox>& objectBounds)
+{
+	const auto numObjects = int(objectBounds.size());
+	_objectBounds = objectBounds;
+	_centroids.resize(numObjects);
+	_objectIndices.clear();
+	for (int i = 0; i < numObjects; i++)
+	{
+		if (!objectBounds[i].isEmpty())
+		{
+			_objectIndices.push_back(i);
+			_centroids[i] = objectBounds[i].getCenter();
+		}
+	}
+
+	// Every split creates two non-empty children, so there are at most 2N - 1 nodes
+	const auto numInserted = int(_objectIndices.size());
+	_nodes.assign(std::max(2 * numInserted - 1, 0), Node());
+	_parents.assign(_nodes.size(), -1);
+	_numNodes = 0;
+	_needsRebuild = false;
+	_dirtyLeaves.clear();
+
+	if (numInserted > 0)
+	{
+		// Enough levels of subtrees built on new threads to occupy all cores
+		const auto numThreads = std::max(1u, std::thread::hardware_concurrency());
+		_parallelDepth = 0;
+		while ((1u << _parallelDepth) < numThreads) {
+			_parallelDepth++;
+		}
+
+		_numNodes = 1;
+		buildNode(0, 0, numInserted, 0);
+	}
+
+	_nodes.resize(_numNodes);
+	_parents.resize(_numNodes);
+	_isLeafDirty.assign(_numNodes, 0);
+
+	_objectLeaves.assign(numObjects, -1);
+	for (int node = 0; node < _numNodes; node++)
+	{
+		const auto& current = _nodes[node];
+		for (int i = 0; i < current.count; i++) {
+			_objectLeaves[_objectIndices[current.leftOrFirst + i]] = node;
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		_leafCenters[axis].resize(numInserted);
+		_leafExtents[axis].resize(numInserted);
+	}
+	updateLeafBoxes(0, numInserted);
+}
+
+void BoundingVolumeHierarchy::updateObject(int object, const BoundingBox& bounds)
+{
+	_objectBounds[object] = bounds;
+
+	const auto leaf = _objectLeaves[object];
+	if (leaf < 0)
+	{
+		_needsRebuild = _needsRebuild || !bounds.isEmpty();
+		return;
+	}
+
+	if (!_isLeafDirty[leaf])
+	{
+		_isLeafDirty[leaf] = 1;
+		_dirtyLeaves.push_back(leaf);
+	}
+}
+
+int BoundingVolumeHierarchy::refit()
+{
+	if (_needsRebuild)
+	{
+		const auto objectBounds = _objectBounds;
+		build(objectBounds);
+		return _numNodes;
+	}
+
+	const auto numRefitted = int(_dirtyLeaves.size());
+	for (const auto leaf : _dirtyLeaves)
+	{
+		_isLeafDirty[leaf] = 0;
+		updateLeafBoxes(_nodes[leaf].leftOrFirst, _nodes[leaf].count);
+		computeNodeBounds(leaf);
+
+		// Ancestors are refitted, until one of them does not change anymore
+		for (auto node = _parents[leaf]; node >= 0; node = _parents[node])
+		{
+			const auto oldMin = _nodes[node].min;
+			const auto oldMax = _nodes[node].max;
+			computeNodeBounds(node);
+			if (_nodes[node].min == oldMin && _nodes[node].max == oldMax) {
+				break;
+			}
+		}
+	}
+	_dirtyLeaves.clear();
+
+	return numRefitted;
+}
+
+int BoundingVolumeHierarchy::queryFrustum(Frustum& frustum, std::vector<int>& objects) const
+{
+	objects.clear();
+	if (_numNodes == 0) {
+		return 0;
+	}
+
+	FrustumStackEntry stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = { 0, false };
+	while (stackSize > 0)
+	{
+		auto entry = stack[--stackSize];
+		const auto& node = _nodes[entry.node];
+		if (!entry.isInside)
+		{
+			BoundingBox nodeBounds;
+			nodeBounds.min = node.min;
+			nodeBounds.max = node.max;
+
+			const auto containment = frustum.classifyBox(nodeBounds);
+			if (containment == Frustum::Containment::Outside) {
+				continue;
+			}
+			entry.isInside = containment == Frustum::Containment::Inside;
+		}
+
+		if (node.count > 0)
+		{
+			if (entry.isInside)
+			{
+				objects.insert(objects.end(), _objectIndices.begin() + node.leftOrFirst, _objectIndices.begin() + node.leftOrFirst + node.count);
+				continue;
+			}
+
+			// Objects of the leaf are tested in batches of four boxes
+			for (int batchFirst = node.leftOrFirst; batchFirst < node.leftOrFirst + node.count; batchFirst += MAX_LEAF_SIZE)
+			{
+				const auto batchSize = std::min(MAX_LEAF_SIZE, node.leftOrFirst + node.count - batchFirst);
+				uint8_t isVisible[MAX_LEAF_SIZE];
+				frustum.cullBoxes(&_leafCenters[0][batchFirst], &_leafCenters[1][batchFirst], &_leafCenters[2][batchFirst],
+					&_leafExtents[0][batchFirst], &_leafExtents[1][batchFirst], &_leafExtents[2][batchFirst], batchSize, isVisible);
+				for (int i = 0; i < batchSize; i++)
+				{
+					if (isVisible[i]) {
+						objects.push_back(_objectIndices[batchFirst + i]);
+					}
+				}
+			}
+			continue;
+		}
+
+		stack[stackSize++] = { node.leftOrFirst + 1, entry.isInside };
+		stack[stackSize++] = { node.leftOrFirst, entry.isInside };
+	}
+
+	const auto numVisible = int(objects.size());
+	frustum.countObjects(numVisible, int(_objectIndices.size()) - numVisible);
+	return numVisible;
+}
+
+int BoundingVolumeHierarchy::queryOverlap(const BoundingBox& box, std::vector<int>& objects) const
+{
+	objects.clear();
+	if (_numNodes == 0 || box.isEmpty()) {
+		return 0;
+	}
+
+	const auto overlaps = [&box](const glm::vec3& min, const glm::vec3& max) {
+		return min.x <= box.max.x && max.x >= box.min.x
+			&& min.y <= box.max.y && max.y >= box.min.y
+			&& min.z <= box.max.z && max.z >= box.min.z;
+	};
+
+	int stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const auto& node = _nodes[stack[--stackSize]];
+		if (!overlaps(node.min, node.max)) {
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (int i = 0; i < node.count; i++)
+			{
+				const auto object = _objectIndices[node.leftOrFirst + i];
+				if (overlaps(_objectBounds[object].min, _objectBounds[object].max)) {
+					objects.push_back(object);
+				}
+			}
+			continue;
+		}
+
+		stack[stackSize++] = node.leftOrFirst + 1;
+		stack[stackSize++] = node.leftOrFirst;
+	}
+
+	return int(objects.size());
+}
+
+BoundingVolumeHierarchy::RayHit BoundingVolumeHierarchy::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	RayHit hit;
+	hit.distance = maxDistance;
+	if (_numNodes == 0) {
+		return hit;
+	}
+
+	const auto inverseDirection = glm::vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	float entryDistance;
+	if (!intersectRay(_nodes[0].min, _nodes[0].max, origin, inverseDirection, hit.distance, entryDistance)) {
+		return hit;
+	}
+
+	int stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const auto& node = _nodes[stack[--stackSize]];
+
+		// Nearer hit might have been found since the node was pushed
+		if (!intersectRay(node.min, node.max, origin, inverseDirection, hit.distance, entryDistance)) {
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (int i = 0; i < node.count; i++)
+			{
+				const auto object = _objectIndices[node.leftOrFirst + i];
+				const auto& bounds = _objectBounds[object];
+				if (intersectRay(bounds.min, bounds.max, origin, inverseDirection, hit.distance, entryDistance))
+				{
+					hit.object = object;
+					hit.distance = entryDistance;
+				}
+			}
+			continue;
+		}
+
+		// Nearer child is visited first, so that farther subtrees are often skipped
+		const auto left = node.leftOrFirst;
+		const auto right = left + 1;
+		float leftDistance, rightDistance;
+		const auto isLeftHit = intersectRay(_nodes[left].min, _nodes[left].max, origin, inverseDirection, hit.distance, leftDistance);
+		const auto isRightHit = intersectRay(_nodes[right].min, _nodes[right].max, origin, inverseDirection, hit.distance, rightDistance);
+		if (isLeftHit && isRightHit)
+		{
+			const auto isLeftNearer = leftDistance <= rightDistance;
+			stack[stackSize++] = isLeftNearer ? right : left;
+			stack[stackSize++] = isLeftNearer ? left : right;
+		}
+		else if (isLeftHit) {
+			stack[stackSize++] = left;
+		}
+		else if (isRightHit) {
+			stack[stackSize++] = right;
+		}
+	}
+
+	return hit;
+}
+
+int BoundingVolumeHierarchy::getNumObjects() const
+{
+	return int(_objectBounds.size());
+}
+
+int BoundingVolumeHierarchy::getNumNodes() const
+{
+	return _numNodes;
+}
+
+void BoundingVolumeHierarchy::buildNode(int node, int first, int count, int depth)
+{
+	BoundingBox centroidBounds;
+	BoundingBox nodeBounds;
+	for (int i = first; i < first + count; i++)
+	{
+		const auto object = _objectIndices[i];
+		nodeBounds.include(_objectBounds[object]);
+		centroidBounds.include(_centroids[object]);
+	}
+	_nodes[node].min = nodeBounds.min;
+	_nodes[node].max = nodeBounds.max;
+	_nodes[node].leftOrFirst = first;
+	_nodes[node].count = count;
+
+	if (count <= 1 || depth >= MAX_DEPTH - 1) {
+		return;
+	}
+
+	int axis;
+	float splitPosition;
+	const auto isSplitCheaper = findBestSplit(first, count, getSurfaceArea(nodeBounds), centroidBounds, axis, splitPosition);
+	if (!isSplitCheaper && count <= MAX_LEAF_SIZE) {
+		return;
+	}
+
+	auto middle = first;
+	if (isSplitCheaper)
+	{
+		const auto begin = _objectIndices.begin();
+		middle = int(std::partition(begin + first, begin + first + count, [this, axis, splitPosition](int object) {
+			return _centroids[object][axis] < splitPosition;
+		}) - begin);
+	}
+
+	if (middle == first || middle == first + count)
+	{
+		// Oversized leaf without a good split, objects are halved along the longest centroid axis
+		const auto extents = centroidBounds.getExtents();
+		axis = extents.x >= extents.y && extents.x >= extents.z ? 0 : extents.y >= extents.z ? 1 : 2;
+		if (extents[axis] <= 0.0f) {
+			return; // All centroids coincide, nothing can separate them
+		}
+
+		const auto begin = _objectIndices.begin();
+		middle = first + count / 2;
+		std::nth_element(begin + first, begin + middle, begin + first + count, [this, axis](int a, int b) {
+			return _centroids[a][axis] < _centroids[b][axis];
+		});
+	}
+
+	// Children are allocated as a pair, always after their parent
+	const auto left = _numNodes.fetch_add(2);
+	_nodes[node].leftOrFirst = left;
+	_nodes[node].count = 0;
+	_parents[left] = node;
+	_parents[left + 1] = node;
+
+	const auto leftCount = middle - first;
+	const auto rightCount = count - leftCount;
+	if (count >= PARALLEL_BUILD_THRESHOLD && depth < _parallelDepth)
+	{
+		// Both halves own disjoint ranges of objects and nodes, so they can be built concurrently
+		auto leftBuild = std::async(std::launch::async, [this, left, first, leftCount, depth] {
+			buildNode(left, first, leftCount, depth + 1);
+		});
+		buildNode(left + 1, middle, rightCount, depth + 1);
+		leftBuild.get();
+	}
+	else
+	{
+		buildNode(left, first, leftCount, depth + 1);
+		buildNode(left + 1, middle, rightCount, depth + 1);
+	}
+}
+
+void BoundingVolumeHierarchy::updateLeafBoxes(int first, int count)
+{
+	for (auto slot = first; slot < first + count; slot++)
+	{
+		const auto& bounds = _objectBounds[_objectIndices[slot]];
+		const auto isEmpty = bounds.isEmpty();
+		const auto center = isEmpty ? glm::vec3(0.0f) : bounds.getCenter();
+		const auto extents = isEmpty ? glm::vec3(-FLT_MAX) : bounds.getExtents();
+		for (int axis = 0; axis < 3; axis++)
+		{
+			_leafCenters[axis][slot] = center[axis];
+			_leafExtents[axis][slot] = extents[axis];
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::computeNodeBounds(int node)
+{
+	auto& current = _nodes[node];
+	BoundingBox bounds;
+	if (current.count > 0)
+	{
+		for (int i = 0; i < current.count; i++) {
+			bounds.include(_objectBounds[_objectIndices[current.leftOrFirst + i]]);
+		}
+	}
+	else
+	{
+		for (int child = current.leftOrFirst; child <= current.leftOrFirst + 1; child++)
+		{
+			BoundingBox childBounds;
+			childBounds.min = _nodes[child].min;
+			childBounds.max = _nodes[child].max;
+			bounds.include(childBounds);
+		}
+	}
+
+	current.min = bounds.min;
+	current.max = bounds.max;
+}
+
+bool BoundingVolumeHierarchy::findBestSplit(int first, int count, float nodeArea, const BoundingBox& centroidBounds, int& axis, float& splitPosition) const
+{
+	auto bestCost = float(count) * nodeArea;
+	auto isFound = false;
+
+	for (int currentAxis = 0; currentAxis < 3; currentAxis++)
+	{
+		const auto minCentroid = centroidBounds.min[currentAxis];
+		const auto extent = centroidBounds.max[currentAxis] - minCentroid;
+		if (extent <= 0.0f) {
+			continue;
+		}
+
+		Bin bins[NUM_BINS];
+		const auto binScale = float(NUM_BINS) / extent;
+		for (int i = first; i < first + count; i++)
+		{
+			const auto object = _objectIndices[i];
+			const auto bin = std::min(NUM_BINS - 1, int((_centroids[object][currentAxis] - minCentroid) * binScale));
+			bins[bin].count++;
+			bins[bin].bounds.include(_objectBounds[object]);
+		}
+
+		// Sweep from the right accumulates areas and counts right of every bin boundary
+		float rightAreas[NUM_BINS - 1];
+		int rightCounts[NUM_BINS - 1];
+		BoundingBox rightBounds;
+		auto rightCount = 0;
+		for (int bin = NUM_BINS - 1; bin > 0; bin--)
+		{
+			rightBounds.include(bins[bin].bounds);
+			rightCount += bins[bin].count;
+			rightAreas[bin - 1] = rightBounds.isEmpty() ? 0.0f : getSurfaceArea(rightBounds);
+			rightCounts[bin - 1] = rightCount;
+		}
+
+		BoundingBox leftBounds;
+		auto leftCount = 0;
+		for (int bin = 0; bin < NUM_BINS - 1; bin++)
+		{
+			leftBounds.include(bins[bin].bounds);
+			leftCount += bins[bin].count;
+			if (leftCount == 0 || rightCounts[bin] == 0) {
+				continue;
+			}
+
+			const auto cost = TRAVERSAL_COST * nodeArea + float(leftCount) * getSurfaceArea(leftBounds) + float(rightCounts[bin]) * rightAreas[bin];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				axis = currentAxis;
+				splitPosition = minCentroid + float(bin + 1) / binScale;
+				isFound = true;
+			}
+		}
+	}
+
+	return isFound;
+}
+
+float BoundingVolumeHierarchy::getSurfaceArea(const BoundingBox& box)
+{
+	const auto size = box.max - box.min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool BoundingVolumeHierarchy::intersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+	float maxDistance, float& entryDistance)
+{
+	// Slab test, the ray enters the box when it is inside all three slabs
+	auto entry = 0.0f;
+	auto exit = maxDistance;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const auto minPlaneDistance = (min[axis] - origin[axis]) * inverseDirection[axis];
+		const auto maxPlaneDistance = (max[axis] - origin[axis]) * inverseDirection[axis];
+		entry = std::max(entry, std::min(minPlaneDistance, maxPlaneDistance));
+		exit = std::min(exit, std::max(minPlaneDistance, maxPlaneDistance));
+	}
+
+	entryDistance = entry;
+	return entry <= exit;
+}
@@ -0,0 +1,111 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "boundingVolumes.h"
+
+class Frustum;
+
+/**
+  Bounding volume hierarchy over objects given by their bounding boxes, used for frustum culling,
+  picking and overlap queries without visiting every object.
+
+  The tree is built top-down with the surface area heuristic evaluated on binned centroids,
+  large subtrees are built in parallel. Nodes live in one flat array, 32 bytes each, children
+  of a node are next to each other and always stored after their parent. Queries walk the tree
+  with a small explicit stack. When objects move, only their leaves and ancestors are refitted,
+  the topology stays the same until the next build. Boxes of leaf objects are also kept in
+  structure-of-arrays form in leaf order, so that frustum queries test a leaf in one batch.
+*/
+class BoundingVolumeHierarchy
+{
+public:
+	static const int NUM_BINS = 16; //!< Number of centroid bins evaluated per axis
+	static const int MAX_LEAF_SIZE = 4; //!< Leaves with more objects are split, unless all centroids coincide
+	static const int PARALLEL_BUILD_THRESHOLD = 4096; //!< Subtrees with at least this many objects are built on another thread
+	static const int MAX_DEPTH = 64; //!< Nodes at this depth become leaves, which bounds the traversal stack
+
+	/** \brief Nearest object hit by a ray. */
+	struct RayHit
+	{
+		int object = -1; //!< Hit object, -1 if nothing was hit
+		float distance = 0.0f; //!< Distance along the ray, in multiples of the direction length
+	};
+
+	/** \brief Builds the hierarchy. Objects are identified by their index, objects with empty boxes are left out. */
+	void build(const std::vector<BoundingBox>& objectBounds);
+
+	/** \brief Changes bounds of an object. Hierarchy is refitted on next refit() call. */
+	void updateObject(int object, const BoundingBox& bounds);
+
+	/** \brief  Refits leaves of changed objects and their ancestors. Rebuilds the hierarchy, if an object left out of it got bounds.
+	*   \return Number of refitted leaves.
+	*/
+	int refit();
+
+	/** \brief  Collects all objects intersecting the frustum. Culled and visible objects are added to counters of the frustum.
+	*   \return Number of visible objects.
+	*/
+	int queryFrustum(Frustum& frustum, std::vector<int>& objects) const;
+
+	/** \brief  Collects all objects, whose boxes overlap given box.
+	*   \return Number of found objects.
+	*/
+	int queryOverlap(const BoundingBox& box, std::vector<int>& objects) const;
+
+	/** \brief  Finds nearest object, whose box is hit by ray within given distance. */
+	RayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+	/** \brief Gets number of objects the hierarchy was built for (including left out ones). */
+	int getNumObjects() const;
+
+	/** \brief Gets number of nodes. */
+	int getNumNodes() const;
+
+private:
+	struct Node
+	{
+		glm::vec3 min;
+		int leftOrFirst; // Left child for inner nodes (right child follows it), first object index for leaves
+		glm::vec3 max;
+		int count; // Number of objects for leaves, 0 for inner nodes
+	};
+
+	struct Bin
+	{
+		BoundingBox bounds;
+		int count = 0;
+	};
+
+	std::vector<Node> _nodes; // Nodes, root first
+	std::atomic<int> _numNodes{ 0 }; // Number of used nodes, incremented concurrently during build
+	std::vector<int> _parents; // Parent of every node, -1 for root
+	std::vector<int> _objectIndices; // Objects referenced by leaves, leaf objects are consecutive
+	std::vector<BoundingBox> _objectBounds; // Current bounds of every object
+	std::vector<float> _leafCenters[3]; // Box centers per axis of objects in leaf order (parallel to object indices)
+	std::vector<float> _leafExtents[3]; // Box extents per axis of objects in leaf order, negative for empty boxes
+	std::vector<glm::vec3> _centroids; // Centroids of object bounds at build time
+	std::vector<int> _objectLeaves; // Leaf containing every object, -1 if object is left out
+	std::vector<int> _dirtyLeaves; // Leaves with changed objects since last refit
+	std::vector<uint8_t> _isLeafDirty; // Flags telling, if leaf is in the dirty list
+	bool _needsRebuild = false; // Flag telling, if an object left out of the hierarchy got bounds
+	int _parallelDepth = 0; // Depth, up to which subtrees are built on new threads
+
+	void buildNode(int node, int first, int count, int depth);
+	void computeNodeBounds(int node);
+	void updateLeafBoxes(int first, int count);
+	bool findBestSplit(int first, int count, float nodeArea, const BoundingBox& centroidBounds, int& axis, float& splitPosition) const;
+
+	static float getSurfaceArea(const BoundingBox& box);
+	static bool intersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+		float maxDistance, float& entryDistance);
+};
+#endif
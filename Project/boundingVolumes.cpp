@@ -0,0 +1,98 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Project
+#include "boundingVolumes.h"
+
+namespace {
+
+	const glm::vec3& getPoint(const void* firstPoint, size_t index, size_t stride)
+	{
+		return *reinterpret_cast<const glm::vec3*>(static_cast<const unsigned char*>(firstPoint) + index * stride);
+	}
+
+} // namespace
+
+BoundingSphere BoundingSphere::fromPoints(const void* firstPoint, size_t numPoints, size_t stride)
+{
+	BoundingSphere sphere;
+	if (numPoints == 0) {
+		return sphere;
+	}
+
+	sphere.center = BoundingBox::fromPoints(firstPoint, numPoints, stride).getCenter();
+
+	// Radius is the farthest point from the center, which is tighter than the sphere around the box
+	auto maxDistanceSquared = 0.0f;
+	for (size_t i = 0; i < numPoints; i++)
+	{
+		const auto offset = getPoint(firstPoint, i, stride) - sphere.center;
+		maxDistanceSquared = std::max(maxDistanceSquared, glm::dot(offset, offset));
+	}
+	sphere.radius = std::sqrt(maxDistanceSquared);
+	return sphere;
+}
+
+BoundingBox BoundingBox::fromPoints(const void* firstPoint, size_t numPoints, size_t stride)
+{
+	BoundingBox box;
+	for (size_t i = 0; i < numPoints; i++) {
+		box.include(getPoint(firstPoint, i, stride));
+	}
+	return box;
+}
+
+bool BoundingBox::isEmpty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+void BoundingBox::include(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void BoundingBox::include(const BoundingBox& box)
+{
+	min = glm::min(min, box.min);
+	max = glm::max(max, box.max);
+}
+
+glm::vec3 BoundingBox::getCenter() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 BoundingBox::getExtents() const
+{
+	return (max - min) * 0.5f;
+}
+
+BoundingSphere BoundingBox::getBoundingSphere() const
+{
+	BoundingSphere sphere;
+	sphere.center = getCenter();
+	sphere.radius = glm::length(getExtents());
+	return sphere;
+}
+
+BoundingBox BoundingBox::transformed(const glm::mat4& matrix) const
+{
+	if (isEmpty()) {
+		return *this;
+	}
+
+	// Center is transformed as a point, extents grow by absolute values of the rotation and scale part (Arvo)
+	const auto center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0f));
+	const auto extents = getExtents();
+	const auto worldExtents = glm::abs(glm::vec3(matrix[0])) * extents.x
+		+ glm::abs(glm::vec3(matrix[1])) * extents.y
+		+ glm::abs(glm::vec3(matrix[2])) * extents.z;
+
+	BoundingBox box;
+	box.min = center - worldExtents;
+	box.max = center + worldExtents;
+	return box;
+}
@@ -0,0 +1,58 @@
+#ifndef BOUNDING_VOLUMES_H
+#define BOUNDING_VOLUMES_H
+
+// STL
+#include <cfloat>
+#include <cstddef>
+
+// GLM
+#include <glm/glm.hpp>
+
+/**
+  Sphere enclosing an object, cheapest volume to test against planes.
+*/
+struct BoundingSphere
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+
+	/** \brief Computes sphere centered in bounding box of the points, enclosing all of them.
+	*   \param firstPoint Position of the first point (3 floats)
+	*   \param numPoints  Number of points
+	*   \param stride     Distance between consecutive points in bytes
+	*/
+	static BoundingSphere fromPoints(const void* firstPoint, size_t numPoints, size_t stride);
+};
+
+/**
+  Axis aligned bounding box. Default constructed box is empty (min is above max),
+  including the first point makes it valid.
+*/
+struct BoundingBox
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	/** \brief Computes box of the points, parameters are the same as in BoundingSphere::fromPoints. */
+	static BoundingBox fromPoints(const void* firstPoint, size_t numPoints, size_t stride);
+
+	/** \brief Checks, if box does not contain any point. */
+	bool isEmpty() const;
+
+	/** \brief Grows box to contain given point or box. */
+	void include(const glm::vec3& point);
+	void include(const BoundingBox& box);
+
+	glm::vec3 getCenter() const;
+
+	/** \brief Gets half of the box size along every axis. */
+	glm::vec3 getExtents() const;
+
+	/** \brief Gets sphere around the box. */
+	BoundingSphere getBoundingSphere() const;
+
+	/** \brief Gets axis aligned box enclosing this box transformed by given matrix. */
+	BoundingBox transformed(const glm::mat4& matrix) const;
+};
+
+#endif
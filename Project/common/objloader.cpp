@@ -2,111 +2,520 @@
 #include <stdio.h>
 #include <string>
 #include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <glm/glm.hpp>
 
 #include "objloader.hpp"
+#include "../mappedFile.h"
 
-// Very, VERY simple OBJ loader.
+// OBJ loader parsing the memory mapped file in place, with its own number parsers instead of fscanf.
+// Large files are split at line boundaries into chunks, which are parsed in parallel and merged afterwards.
+// Supported : v, vt and vn records, faces with any number of corners (triangulated as fans),
+// negative (relative) indices and corners without texture coordinate or normal.
+// Missing texture coordinates are (0, 0), missing normals are replaced by the face normal.
+// usemtl records split the triangles into submeshes, other records (o, g, s, mtllib, l, p, comments) are skipped.
 // Here is a short list of features a real function would provide : 
 // - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime. In short : OBJ is not very great.
+//   (CookedMesh caches the parsed and indexed model in such a file next to the OBJ)
 // - Animations & bones (includes bones weights)
 // - Multiple UVs
-// - All attributes should be optional, not "forced"
-// - More stable. Change a line in the OBJ file and it crashes.
-// - More secure. Change another line and you can inject code.
+// - Materials (only their names are kept)
 // - Loading from memory, stream, etc
 
+namespace {
+
+	// Exactly representable powers of ten, used to scale parsed mantissas
+	const double POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	// Chunks are at least this big, smaller files are parsed by a single thread
+	const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+	// Number of chunks per thread, more chunks balance the load better
+	const size_t CHUNKS_PER_THREAD = 4;
+
+	// Triangles de-indexed by one task
+	const size_t TRIANGLES_PER_TASK = 1 << 16;
+
+	// Bits of ObjCorner::relativeMask
+	const unsigned char RELATIVE_POSITION = 1;
+	const unsigned char RELATIVE_UV = 2;
+	const unsigned char RELATIVE_NORMAL = 4;
+
+	// Corner of a face, attribute indices are zero based, -1 if the attribute is missing.
+	// Negative OBJ indices count from the attributes read so far, which in a chunk are only known
+	// relative to the start of the chunk, such indices are marked in the mask until the chunks are merged.
+	struct ObjCorner {
+		int position;
+		int uv;
+		int normal;
+		unsigned char relativeMask;
+	};
+
+	// usemtl record, triangles from firstCorner on use the material
+	struct ObjMaterialRecord {
+		size_t firstCorner;
+		std::string name;
+	};
+
+	// Records of a part of the file, faces are already triangulated
+	struct ObjChunk {
+		const char * begin;
+		const char * end;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+		std::vector<ObjCorner> corners; // Three per triangle
+		std::vector<ObjMaterialRecord> materials; // Corners are relative to the chunk
+		const char * errorPosition; // Start of the first malformed line, NULL if there is none
+
+		// Numbers of records in all previous chunks
+		size_t positionBase;
+		size_t uvBase;
+		size_t normalBase;
+		size_t cornerBase;
+	};
+
+	// Runs task(0) ... task(numTasks - 1) on all hardware threads, the calling thread helps as well
+	template <typename Task>
+	void parallelFor(size_t numTasks, const Task & task){
+		std::atomic<size_t> nextTask(0);
+		const auto worker = [&](){
+			for( size_t i = nextTask++; i < numTasks; i = nextTask++ )
+				task(i);
+		};
+
+		const size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numTasks);
+		std::vector<std::thread> threads;
+		for( size_t i = 1; i < numThreads; i++ )
+			threads.emplace_back(worker);
+		worker();
+		for( auto & thread : threads )
+			thread.join();
+	}
+
+	inline bool isBlank(char c){
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline bool isDigit(char c){
+		return c >= '0' && c <= '9';
+	}
+
+	inline const char * skipBlanks(const char * p, const char * end){
+		while( p < end && isBlank(*p) )
+			p++;
+		return p;
+	}
+
+	inline const char * findLineEnd(const char * p, const char * end){
+		const char * lineEnd = static_cast<const char *>(memchr(p, '\n', end - p));
+		return lineEnd != NULL ? lineEnd : end;
+	}
+
+	// Parses decimal number with optional sign, fraction and exponent, e.g. -1.25e-3
+	bool parseFloat(const char *& p, const char * end, float & value){
+		const char * s = p;
+		bool isNegative = false;
+		if( s < end && (*s == '-' || *s == '+') ){
+			isNegative = *s == '-';
+			s++;
+		}
+
+		// Up to 19 significant digits fit into the mantissa, further ones only shift the exponent
+		uint64_t mantissa = 0;
+		int numSignificantDigits = 0;
+		int exponent = 0;
+		bool hasDigits = false;
+		for( ; s < end && isDigit(*s); s++ ){
+			hasDigits = true;
+			if( numSignificantDigits < 19 ){
+				mantissa = mantissa * 10 + (*s - '0');
+				numSignificantDigits += mantissa != 0;
+			}else{
+				exponent++;
+			}
+		}
+		if( s < end && *s == '.' ){
+			for( s++; s < end && isDigit(*s); s++ ){
+				hasDigits = true;
+				if( numSignificantDigits < 19 ){
+					mantissa = mantissa * 10 + (*s - '0');
+					numSignificantDigits += mantissa != 0;
+					exponent--;
+				}
+			}
+		}
+		if( !hasDigits )
+			return false;
+
+		if( s < end && (*s == 'e' || *s == 'E') ){
+			const char * e = s + 1;
+			bool isExponentNegative = false;
+			if( e < end && (*e == '-' || *e == '+') ){
+				isExponentNegative = *e == '-';
+				e++;
+			}
+			if( e < end && isDigit(*e) ){
+				int exponentValue = 0;
+				for( ; e < end && isDigit(*e); e++ ){
+					if( exponentValue < 10000 )
+						exponentValue = exponentValue * 10 + (*e - '0');
+				}
+				exponent += isExponentNegative ? -exponentValue : exponentValue;
+				s = e;
+			}
+		}
+
+		double result = double(mantissa);
+		if( mantissa != 0 && exponent != 0 ){
+			if( exponent > 0 && exponent <= 22 )
+				result *= POWERS_OF_TEN[exponent];
+			else if( exponent < 0 && exponent >= -22 )
+				result /= POWERS_OF_TEN[-exponent];
+			else
+				result *= pow(10.0, exponent);
+		}
+
+		value = float(isNegative ? -result : result);
+		p = s;
+		return true;
+	}
+
+	bool parseInt(const char *& p, const char * end, int & value){
+		const char * s = p;
+		bool isNegative = false;
+		if( s < end && (*s == '-' || *s == '+') ){
+			isNegative = *s == '-';
+			s++;
+		}
+		if( s >= end || !isDigit(*s) )
+			return false;
+
+		int result = 0;
+		for( ; s < end && isDigit(*s); s++ )
+			result = result * 10 + (*s - '0');
+
+		value = isNegative ? -result : result;
+		p = s;
+		return true;
+	}
+
+	// Parses OBJ index : 1-based ones become zero based, negative ones are made relative to the start of the chunk
+	bool parseIndex(const char *& p, const char * end, size_t numRead, int & index, bool & isRelative){
+		int value;
+		if( !parseInt(p, end, value) || value == 0 )
+			return false;
+
+		isRelative = value < 0;
+		index = isRelative ? int(numRead) + value : value - 1;
+		return true;
+	}
+
+	// Parses one face corner : v, v/vt, v//vn or v/vt/vn
+	bool parseCorner(const char *& p, const char * end, const ObjChunk & chunk, ObjCorner & corner){
+		bool isRelative;
+		corner.uv = -1;
+		corner.normal = -1;
+		corner.relativeMask = 0;
+		if( !parseIndex(p, end, chunk.positions.size(), corner.position, isRelative) )
+			return false;
+		corner.relativeMask |= isRelative ? RELATIVE_POSITION : 0;
+
+		if( p < end && *p == '/' ){
+			p++;
+			if( p < end && *p != '/' ){
+				if( !parseIndex(p, end, chunk.uvs.size(), corner.uv, isRelative) )
+					return false;
+				corner.relativeMask |= isRelative ? RELATIVE_UV : 0;
+			}
+			if( p < end && *p == '/' ){
+				p++;
+				if( !parseIndex(p, end, chunk.normals.size(), corner.normal, isRelative) )
+					return false;
+				corner.relativeMask |= isRelative ? RELATIVE_NORMAL : 0;
+			}
+		}
+		return p == end || isBlank(*p);
+	}
+
+	// Turns corner index into index of the merged arrays, -1 if it is out of range
+	inline int resolveIndex(int index, bool isRelative, size_t base, size_t count){
+		const long long resolved = isRelative ? (long long)base + index : index;
+		return resolved >= 0 && resolved < (long long)count ? int(resolved) : -1;
+	}
+
+	// Counts records, so that all arrays can be reserved up front
+	void reserveRecords(const char * begin, const char * end, ObjChunk & data){
+		size_t numPositions = 0, numUvs = 0, numNormals = 0, numFaces = 0;
+		for( const char * p = begin; p < end; p = findLineEnd(p, end) + 1 ){
+			p = skipBlanks(p, end);
+			if( end - p < 2 )
+				continue;
+			if( p[0] == 'v' ){
+				numPositions += isBlank(p[1]);
+				numUvs += p[1] == 't';
+				numNormals += p[1] == 'n';
+			}else if( p[0] == 'f' ){
+				numFaces += isBlank(p[1]);
+			}
+		}
+
+		data.positions.reserve(numPositions);
+		data.uvs.reserve(numUvs);
+		data.normals.reserve(numNormals);
+		data.corners.reserve(numFaces * 3);
+	}
+
+	// Parses all records of the chunk, stops at the first malformed line
+	void parseChunk(ObjChunk & chunk){
+		const char * end = chunk.end;
+		reserveRecords(chunk.begin, end, chunk);
+
+		std::vector<ObjCorner> polygon;
+		for( const char * lineStart = chunk.begin; lineStart < end; ){
+			const char * lineEnd = findLineEnd(lineStart, end);
+			const char * p = skipBlanks(lineStart, lineEnd);
+			bool isValid = true;
+
+			if( lineEnd - p >= 2 && p[0] == 'v' && isBlank(p[1]) ){
+				glm::vec3 vertex;
+				p += 2;
+				isValid = parseFloat(p = skipBlanks(p, lineEnd), lineEnd, vertex.x)
+					&& parseFloat(p = skipBlanks(p, lineEnd), lineEnd, vertex.y)
+					&& parseFloat(p = skipBlanks(p, lineEnd), lineEnd, vertex.z);
+				chunk.positions.push_back(vertex);
+			}else if( lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && isBlank(p[2]) ){
+				glm::vec2 uv(0.0f);
+				p += 3;
+				isValid = parseFloat(p = skipBlanks(p, lineEnd), lineEnd, uv.x);
+				parseFloat(p = skipBlanks(p, lineEnd), lineEnd, uv.y); // Second coordinate is optional
+				uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
+				chunk.uvs.push_back(uv);
+			}else if( lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && isBlank(p[2]) ){
+				glm::vec3 normal;
+				p += 3;
+				isValid = parseFloat(p = skipBlanks(p, lineEnd), lineEnd, normal.x)
+					&& parseFloat(p = skipBlanks(p, lineEnd), lineEnd, normal.y)
+					&& parseFloat(p = skipBlanks(p, lineEnd), lineEnd, normal.z);
+				chunk.normals.push_back(normal);
+			}else if( lineEnd - p >= 2 && p[0] == 'f' && isBlank(p[1]) ){
+				polygon.clear();
+				for( p = skipBlanks(p + 2, lineEnd); isValid && p < lineEnd; p = skipBlanks(p, lineEnd) ){
+					ObjCorner corner;
+					isValid = parseCorner(p, lineEnd, chunk, corner);
+					polygon.push_back(corner);
+				}
+				isValid = isValid && polygon.size() >= 3;
+
+				// Polygons are triangulated as fans around their first corner
+				for( size_t i = 2; isValid && i < polygon.size(); i++ ){
+					chunk.corners.push_back(polygon[0]);
+					chunk.corners.push_back(polygon[i - 1]);
+					chunk.corners.push_back(polygon[i]);
+				}
+			}else if( lineEnd - p >= 7 && memcmp(p, "usemtl", 6) == 0 && isBlank(p[6]) ){
+				// Name is the rest of the line without surrounding blanks
+				const char * nameBegin = skipBlanks(p + 7, lineEnd);
+				const char * nameEnd = lineEnd;
+				while( nameEnd > nameBegin && isBlank(nameEnd[-1]) )
+					nameEnd--;
+
+				ObjMaterialRecord material;
+				material.firstCorner = chunk.corners.size();
+				material.name.assign(nameBegin, nameEnd);
+				chunk.materials.push_back(material);
+			}
+
+			if( !isValid ){
+				chunk.errorPosition = lineStart;
+				return;
+			}
+			lineStart = lineEnd + 1;
+		}
+	}
+
+	// Splits file into chunks, every chunk ends right after a line break
+	std::vector<ObjChunk> splitIntoChunks(const char * begin, const char * end){
+		const size_t numBytes = size_t(end - begin);
+		const size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+		const size_t numChunks = std::max<size_t>(1, std::min(numBytes / MIN_CHUNK_BYTES, numThreads * CHUNKS_PER_THREAD));
+
+		std::vector<ObjChunk> chunks;
+		const char * chunkBegin = begin;
+		for( size_t i = 1; i <= numChunks && chunkBegin < end; i++ ){
+			const char * chunkEnd = i == numChunks ? end : std::max(chunkBegin, begin + numBytes / numChunks * i);
+			if( chunkEnd < end )
+				chunkEnd = std::min(findLineEnd(chunkEnd, end) + 1, end);
+
+			ObjChunk chunk;
+			chunk.begin = chunkBegin;
+			chunk.end = chunkEnd;
+			chunk.errorPosition = NULL;
+			chunks.push_back(std::move(chunk));
+			chunkBegin = chunkEnd;
+		}
+		return chunks;
+	}
+
+	// Copies attributes of all chunks into the first arrays and resolves corners against the merged arrays.
+	// Offsets of the chunks are prefix sums of the numbers of records, so results equal parsing the file at once.
+	bool mergeChunks(std::vector<ObjChunk> & chunks, std::vector<glm::vec3> & positions, std::vector<glm::vec2> & uvs,
+		std::vector<glm::vec3> & normals, std::vector<ObjCorner> & corners){
+		size_t numPositions = 0, numUvs = 0, numNormals = 0, numCorners = 0;
+		for( auto & chunk : chunks ){
+			chunk.positionBase = numPositions;
+			chunk.uvBase = numUvs;
+			chunk.normalBase = numNormals;
+			chunk.cornerBase = numCorners;
+			numPositions += chunk.positions.size();
+			numUvs += chunk.uvs.size();
+			numNormals += chunk.normals.size();
+			numCorners += chunk.corners.size();
+		}
+
+		positions.resize(numPositions);
+		uvs.resize(numUvs);
+		normals.resize(numNormals);
+		corners.resize(numCorners);
+
+		std::atomic<bool> isInRange(true);
+		parallelFor(chunks.size(), [&](size_t i){
+			const ObjChunk & chunk = chunks[i];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+			std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uvBase);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+
+			bool isChunkInRange = true;
+			ObjCorner * resolved = corners.data() + chunk.cornerBase;
+			for( const auto & corner : chunk.corners ){
+				resolved->position = resolveIndex(corner.position, (corner.relativeMask & RELATIVE_POSITION) != 0, chunk.positionBase, numPositions);
+				resolved->uv = corner.uv == -1 && !(corner.relativeMask & RELATIVE_UV) ? -1
+					: resolveIndex(corner.uv, (corner.relativeMask & RELATIVE_UV) != 0, chunk.uvBase, numUvs);
+				resolved->normal = corner.normal == -1 && !(corner.relativeMask & RELATIVE_NORMAL) ? -1
+					: resolveIndex(corner.normal, (corner.relativeMask & RELATIVE_NORMAL) != 0, chunk.normalBase, numNormals);
+				resolved->relativeMask = 0;
+
+				// Present attribute resolving to -1 is out of range
+				isChunkInRange = isChunkInRange && resolved->position >= 0
+					&& (resolved->uv >= 0 || (corner.uv == -1 && !(corner.relativeMask & RELATIVE_UV)))
+					&& (resolved->normal >= 0 || (corner.normal == -1 && !(corner.relativeMask & RELATIVE_NORMAL)));
+				resolved++;
+			}
+			if( !isChunkInRange )
+				isInRange = false;
+		});
+		return isInRange;
+	}
+
+} // namespace
+
 bool loadOBJ(
 	const char * path, 
 	std::vector<glm::vec3> & out_vertices, 
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
-	printf("Loading OBJ file %s...\n", path);
-
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices; 
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
+	std::vector<ObjSubmesh> submeshes;
+	return loadOBJ(path, out_vertices, out_uvs, out_normals, submeshes);
+}
 
+bool loadOBJ(
+	const char * path, 
+	std::vector<glm::vec3> & out_vertices, 
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<ObjSubmesh> & out_submeshes
+){
+	printf("Loading OBJ file %s...\n", path);
 
-	FILE * file = fopen(path, "r");
-	if( file == NULL ){
+	MappedFile file;
+	if( !file.open(path) ){
 		printf("Impossible to open the file ! Are you in the right path ? See Tutorial 1 for details\n");
 		getchar();
 		return false;
 	}
 
-	while( 1 ){
-
-		char lineHeader[128];
-		// read the first word of the line
-		int res = fscanf(file, "%s", lineHeader);
-		if (res == EOF)
-			break; // EOF = End Of File. Quit the loop.
-
-		// else : parse lineHeader
-		
-		if ( strcmp( lineHeader, "v" ) == 0 ){
-			glm::vec3 vertex;
-			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z );
-			temp_vertices.push_back(vertex);
-		}else if ( strcmp( lineHeader, "vt" ) == 0 ){
-			glm::vec2 uv;
-			fscanf(file, "%f %f\n", &uv.x, &uv.y );
-			uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
-			temp_uvs.push_back(uv);
-		}else if ( strcmp( lineHeader, "vn" ) == 0 ){
-			glm::vec3 normal;
-			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z );
-			temp_normals.push_back(normal);
-		}else if ( strcmp( lineHeader, "f" ) == 0 ){
-			std::string vertex1, vertex2, vertex3;
-			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
-			if (matches != 9){
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file);
-				return false;
-			}
-			vertexIndices.push_back(vertexIndex[0]);
-			vertexIndices.push_back(vertexIndex[1]);
-			vertexIndices.push_back(vertexIndex[2]);
-			uvIndices    .push_back(uvIndex[0]);
-			uvIndices    .push_back(uvIndex[1]);
-			uvIndices    .push_back(uvIndex[2]);
-			normalIndices.push_back(normalIndex[0]);
-			normalIndices.push_back(normalIndex[1]);
-			normalIndices.push_back(normalIndex[2]);
-		}else{
-			// Probably a comment, eat up the rest of the line
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file);
+	const char * begin = reinterpret_cast<const char *>(file.getData());
+	const char * end = begin + file.getSize();
+	std::vector<ObjChunk> chunks = splitIntoChunks(begin, end);
+	parallelFor(chunks.size(), [&chunks](size_t i){
+		parseChunk(chunks[i]);
+	});
+
+	for( const auto & chunk : chunks ){
+		if( chunk.errorPosition != NULL ){
+			const long line = 1 + long(std::count(begin, chunk.errorPosition, '\n'));
+			printf("%s:%ld: malformed record\n", path, line);
+			return false;
 		}
+	}
 
+	std::vector<glm::vec3> positions, normals;
+	std::vector<glm::vec2> uvs;
+	std::vector<ObjCorner> corners;
+	const bool isInRange = mergeChunks(chunks, positions, uvs, normals, corners);
+	if( !isInRange ){
+		printf("%s: face index out of range\n", path);
+		return false;
 	}
 
-	// For each vertex of each triangle
-	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
-
-		// Get the indices of its attributes
-		unsigned int vertexIndex = vertexIndices[i];
-		unsigned int uvIndex = uvIndices[i];
-		unsigned int normalIndex = normalIndices[i];
-		
-		// Get the attributes thanks to the index
-		glm::vec3 vertex = temp_vertices[ vertexIndex-1 ];
-		glm::vec2 uv = temp_uvs[ uvIndex-1 ];
-		glm::vec3 normal = temp_normals[ normalIndex-1 ];
-		
-		// Put the attributes in buffers
-		out_vertices.push_back(vertex);
-		out_uvs     .push_back(uv);
-		out_normals .push_back(normal);
-	
+	// Every usemtl record starts a new submesh, empty submeshes are dropped
+	const size_t numCorners = corners.size();
+	const size_t outputBase = out_vertices.size();
+	ObjSubmesh submesh;
+	submesh.firstVertex = outputBase;
+	out_submeshes.clear();
+	for( const auto & chunk : chunks ){
+		for( const auto & material : chunk.materials ){
+			submesh.numVertices = outputBase + chunk.cornerBase + material.firstCorner - submesh.firstVertex;
+			if( submesh.numVertices > 0 )
+				out_submeshes.push_back(submesh);
+			submesh.material = material.name;
+			submesh.firstVertex += submesh.numVertices;
+		}
 	}
-	fclose(file);
+	submesh.numVertices = outputBase + numCorners - submesh.firstVertex;
+	if( submesh.numVertices > 0 )
+		out_submeshes.push_back(submesh);
+	chunks.clear();
+
+	// For each vertex of each triangle, triangles are de-indexed in parallel into their final place
+	out_vertices.resize(outputBase + numCorners);
+	out_uvs     .resize(outputBase + numCorners);
+	out_normals .resize(outputBase + numCorners);
+
+	const size_t numTriangles = numCorners / 3;
+	parallelFor((numTriangles + TRIANGLES_PER_TASK - 1) / TRIANGLES_PER_TASK, [&](size_t task){
+		const size_t lastTriangle = std::min(numTriangles, (task + 1) * TRIANGLES_PER_TASK);
+		for( size_t i = task * TRIANGLES_PER_TASK * 3; i < lastTriangle * 3; i += 3 ){
+			const ObjCorner * triangle = &corners[i];
+
+			// Flat normal of the triangle replaces missing vertex normals
+			glm::vec3 faceNormal(0.0f);
+			if( triangle[0].normal < 0 || triangle[1].normal < 0 || triangle[2].normal < 0 ){
+				const glm::vec3 & p0 = positions[triangle[0].position];
+				const glm::vec3 normal = glm::cross(positions[triangle[1].position] - p0, positions[triangle[2].position] - p0);
+				const float length = glm::length(normal);
+				if( length > 0.0f )
+					faceNormal = normal / length;
+			}
+
+			// Put the attributes in buffers
+			for( int corner = 0; corner < 3; corner++ ){
+				out_vertices[outputBase + i + corner] = positions[triangle[corner].position];
+				out_uvs     [outputBase + i + corner] = triangle[corner].uv >= 0 ? uvs[triangle[corner].uv] : glm::vec2(0.0f);
+				out_normals [outputBase + i + corner] = triangle[corner].normal >= 0 ? normals[triangle[corner].normal] : faceNormal;
+			}
+		}
+	});
 	return true;
 }
 
@@ -1,6 +1,15 @@
 #ifndef OBJLOADER_H
 #define OBJLOADER_H
 
+#include <string>
+
+// Consecutive vertices of the loaded triangle soup, which use one material
+struct ObjSubmesh {
+	std::string material; // Name from the usemtl record, empty before the first one
+	size_t firstVertex;
+	size_t numVertices;
+};
+
 bool loadOBJ(
 	const char * path, 
 	std::vector<glm::vec3> & out_vertices, 
@@ -8,6 +17,15 @@ bool loadOBJ(
 	std::vector<glm::vec3> & out_normals
 );
 
+// Same as above, also splits the triangles into submeshes by their materials
+bool loadOBJ(
+	const char * path, 
+	std::vector<glm::vec3> & out_vertices, 
+	std::vector<glm::vec2> & out_uvs, 
+	std::vector<glm::vec3> & out_normals,
+	std::vector<ObjSubmesh> & out_submeshes
+);
+
 
 
 bool loadAssImp(
@@ -18,4 +36,4 @@ bool loadAssImp(
 	std::vector<glm::vec3> & normals
 );
 
-#endif
\ No newline at end of file
+#endif
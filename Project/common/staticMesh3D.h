@@ -1,10 +1,26 @@
 #pragma once
 
+// STL
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
 #include "vertexBufferObject.h"
+#include "../boundingVolumes.h"
 
 
 namespace static_meshes_3D {
 
+/**
+	Describes how vertex attributes of a static mesh are laid out in its VBO.
+*/
+enum class VertexLayout
+{
+	Planar, //!< All positions first, then all texture coordinates, then all normals
+	Interleaved //!< Position, texture coordinate and normal packed together for every vertex
+};
+
 /**
 	Represents generic 3D static mesh.
 */
@@ -15,7 +31,7 @@ public:
 	static const int TEXTURE_COORDINATE_ATTRIBUTE_INDEX; //!< Vertex attribute index of texture coordinate (1)
 	static const int NORMAL_ATTRIBUTE_INDEX; //!< Vertex attribute index of vertex normal (2)
 
-	StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals);
+	StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout = VertexLayout::Planar);
 	virtual ~StaticMesh3D();
 
 	/** \brief  Renders static mesh. */
@@ -24,6 +40,11 @@ public:
 	/** \brief  Renders static mesh as points only. */
 	virtual void renderPoints() const {}
 
+	/** \brief  Renders given number of instances of static mesh in one draw call.
+	*   Per-instance attributes must already be set up in the mesh VAO.
+	*/
+	virtual void renderInstanced(int /*numInstances*/) const {}
+
 	/** \brief  Deletes static mesh data. */
 	virtual void deleteMesh();
 
@@ -42,24 +63,52 @@ public:
 	*/
 	bool hasNormals() const;
 
+	/** \brief  Gets layout of vertex attributes in the VBO.
+	*   \return Planar or interleaved vertex layout.
+	*/
+	VertexLayout getVertexLayout() const;
+
 	/** \brief  Calculates byte size of one vertex, depending on its attributes.
-	*   \return True if it has or false otherwise.
+	*   \return Byte size of one vertex. With interleaved layout, this is also the vertex stride.
 	*/
 	int getVertexByteSize() const;
 
+	/** \brief  Gets VAO of static mesh, so that additional attributes can be attached to it.
+	*   \return VAO ID from OpenGL.
+	*/
+	GLuint getVAO() const;
+
+	/** \brief  Gets axis aligned bounding box of the mesh in its local space.
+	*   \return Bounding box, empty if mesh has no positions.
+	*/
+	const BoundingBox& getBounds() const;
+
+	/** \brief  Gets bounding sphere of the mesh in its local space.
+	*   \return Bounding sphere, zero radius if mesh has no positions.
+	*/
+	const BoundingSphere& getBoundingSphere() const;
+
 protected:
 	bool _hasPositions = false; //!< Flag telling, if we have vertex positions
 	bool _hasTextureCoordinates = false; //!< Flag telling, if we have texture coordinates
 	bool _hasNormals = false; //!< Flag telling, if we have vertex normals
+	VertexLayout _vertexLayout = VertexLayout::Planar; //!< Layout of vertex attributes in the VBO
 
 	bool _isInitialized = false; //!< Is mesh initialized flag
 	GLuint _vao = 0; //!< VAO ID from OpenGL
 	VertexBufferObject _vbo; //!< Our VBO wrapper class holding static mesh data
+	BoundingBox _bounds; //!< Local bounding box, computed from positions in addVertexData
+	BoundingSphere _boundingSphere; //!< Local bounding sphere, computed from positions in addVertexData
 
 	/** \brief  Initializes vertex data. */
 	virtual void initializeData() {};
 
-	/** \brief  Sets vertex attribute pointers in a standard way. */
+	/** \brief  Adds vertex attributes to the VBO in the mesh vertex layout and computes bounding volumes from positions.
+	*   Only the attributes the mesh has are read, the other vectors may be empty.
+	*/
+	void addVertexData(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& textureCoordinates, const std::vector<glm::vec3>& normals);
+
+	/** \brief  Sets vertex attribute pointers in a standard way, respecting the mesh vertex layout. */
 	void setVertexAttributesPointers(int numVertices);
 };
 
@@ -10,7 +10,7 @@ namespace static_meshes_3D {
 class StaticMeshIndexed3D : public StaticMesh3D
 {
 public:
-	StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals);
+	StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout = VertexLayout::Planar);
 	virtual ~StaticMeshIndexed3D();
 
 	void deleteMesh() override;
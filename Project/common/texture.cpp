@@ -1,10 +1,35 @@
+// The BMP loader reads with stdio, which SDL checks of MSVC reject as unsafe (C4996)
+#define _CRT_SECURE_NO_WARNINGS
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include <GL/glew.h>
-
-#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+
+#include "../glStateCache.h"
+#include "../mappedFile.h"
+#include "texture.hpp"
+
+// S3TC formats are extensions, which the core profile loader does not define
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
 
 
 GLuint loadBMP_custom(const char * imagepath){
@@ -69,7 +94,7 @@ GLuint loadBMP_custom(const char * imagepath){
 	glGenTextures(1, &textureID);
 	
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
 
 	// Give the image to OpenGL
 	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
@@ -120,99 +145,265 @@ GLuint loadBMP_custom(const char * imagepath){
 
 
 
+// Four character codes of DDS pixel formats
 #define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
 #define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
 #define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
+#define FOURCC_ATI1 0x31495441 // Equivalent to "ATI1" in ASCII
+#define FOURCC_BC4U 0x55344342 // Equivalent to "BC4U" in ASCII
+#define FOURCC_BC4S 0x53344342 // Equivalent to "BC4S" in ASCII
+#define FOURCC_ATI2 0x32495441 // Equivalent to "ATI2" in ASCII
+#define FOURCC_BC5U 0x55354342 // Equivalent to "BC5U" in ASCII
+#define FOURCC_BC5S 0x53354342 // Equivalent to "BC5S" in ASCII
+#define FOURCC_DX10 0x30315844 // Equivalent to "DX10" in ASCII, DXGI format is in the extended header
+
+// DDS header flags
+#define DDPF_FOURCC 0x4
+#define DDSCAPS2_CUBEMAP 0x200
+#define DDSCAPS2_VOLUME 0x200000
+#define DDS_DIMENSION_TEXTURE2D 3
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4
+
+// DXGI formats of the DX10 header
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC1_UNORM_SRGB 72
+#define DXGI_FORMAT_BC2_UNORM 74
+#define DXGI_FORMAT_BC2_UNORM_SRGB 75
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC3_UNORM_SRGB 78
+#define DXGI_FORMAT_BC4_UNORM 80
+#define DXGI_FORMAT_BC4_SNORM 81
+#define DXGI_FORMAT_BC5_UNORM 83
+#define DXGI_FORMAT_BC5_SNORM 84
+#define DXGI_FORMAT_BC7_UNORM 98
+#define DXGI_FORMAT_BC7_UNORM_SRGB 99
+
+// Layout of the file after the "DDS " magic, all fields are little endian
+struct DDSPixelFormat {
+	unsigned int size;
+	unsigned int flags;
+	unsigned int fourCC;
+	unsigned int rgbBitCount;
+	unsigned int masks[4];
+};
+
+struct DDSHeader {
+	unsigned int size;
+	unsigned int flags;
+	unsigned int height;
+	unsigned int width;
+	unsigned int pitchOrLinearSize;
+	unsigned int depth;
+	unsigned int mipMapCount;
+	unsigned int reserved1[11];
+	DDSPixelFormat pixelFormat;
+	unsigned int caps;
+	unsigned int caps2;
+	unsigned int caps3;
+	unsigned int caps4;
+	unsigned int reserved2;
+};
+
+struct DDSHeaderDX10 {
+	unsigned int dxgiFormat;
+	unsigned int resourceDimension;
+	unsigned int miscFlag;
+	unsigned int arraySize;
+	unsigned int miscFlags2;
+};
+
+// Gets OpenGL format and size of 4x4 block of legacy four character code, 0 if not supported
+static GLenum getFourCCFormat(unsigned int fourCC, unsigned int * blockSize){
+	switch(fourCC)
+	{
+	case FOURCC_DXT1: *blockSize = 8;  return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case FOURCC_DXT3: *blockSize = 16; return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case FOURCC_DXT5: *blockSize = 16; return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case FOURCC_ATI1:
+	case FOURCC_BC4U: *blockSize = 8;  return GL_COMPRESSED_RED_RGTC1;
+	case FOURCC_BC4S: *blockSize = 8;  return GL_COMPRESSED_SIGNED_RED_RGTC1;
+	case FOURCC_ATI2:
+	case FOURCC_BC5U: *blockSize = 16; return GL_COMPRESSED_RG_RGTC2;
+	case FOURCC_BC5S: *blockSize = 16; return GL_COMPRESSED_SIGNED_RG_RGTC2;
+	default: return 0;
+	}
+}
 
-GLuint loadDDS(const char * imagepath){
+// Gets OpenGL format and size of 4x4 block of DXGI format, 0 if not supported
+static GLenum getDXGIFormat(unsigned int dxgiFormat, unsigned int * blockSize){
+	switch(dxgiFormat)
+	{
+	case DXGI_FORMAT_BC1_UNORM:      *blockSize = 8;  return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case DXGI_FORMAT_BC1_UNORM_SRGB: *blockSize = 8;  return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+	case DXGI_FORMAT_BC2_UNORM:      *blockSize = 16; return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case DXGI_FORMAT_BC2_UNORM_SRGB: *blockSize = 16; return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+	case DXGI_FORMAT_BC3_UNORM:      *blockSize = 16; return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case DXGI_FORMAT_BC3_UNORM_SRGB: *blockSize = 16; return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+	case DXGI_FORMAT_BC4_UNORM:      *blockSize = 8;  return GL_COMPRESSED_RED_RGTC1;
+	case DXGI_FORMAT_BC4_SNORM:      *blockSize = 8;  return GL_COMPRESSED_SIGNED_RED_RGTC1;
+	case DXGI_FORMAT_BC5_UNORM:      *blockSize = 16; return GL_COMPRESSED_RG_RGTC2;
+	case DXGI_FORMAT_BC5_SNORM:      *blockSize = 16; return GL_COMPRESSED_SIGNED_RG_RGTC2;
+	case DXGI_FORMAT_BC7_UNORM:      *blockSize = 16; return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	case DXGI_FORMAT_BC7_UNORM_SRGB: *blockSize = 16; return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+	default: return 0;
+	}
+}
 
-	unsigned char header[124];
+// Exact size of one mip level, every dimension is padded to whole 4x4 blocks
+static size_t getLevelSize(unsigned int width, unsigned int height, unsigned int blockSize){
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+}
+
+bool parseDDS(const char * imagepath, const unsigned char * data, size_t fileSize, DDSImage & image){
 
-	FILE *fp; 
- 
-	/* try to open the file */ 
-	fp = fopen(imagepath, "rb"); 
-	if (fp == NULL){
-		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath); getchar(); 
-		return 0;
-	}
-   
 	/* verify the type of file */ 
-	char filecode[4]; 
-	fread(filecode, 1, 4, fp); 
-	if (strncmp(filecode, "DDS ", 4) != 0) { 
-		fclose(fp); 
-		return 0; 
+	if (fileSize < 4 + sizeof(DDSHeader) || strncmp((const char*)data, "DDS ", 4) != 0) {
+		printf("%s is not a correct DDS file\n", imagepath);
+		return false; 
 	}
-	
+
 	/* get the surface desc */ 
-	fread(&header, 124, 1, fp); 
-
-	unsigned int height      = *(unsigned int*)&(header[8 ]);
-	unsigned int width	     = *(unsigned int*)&(header[12]);
-	unsigned int linearSize	 = *(unsigned int*)&(header[16]);
-	unsigned int mipMapCount = *(unsigned int*)&(header[24]);
-	unsigned int fourCC      = *(unsigned int*)&(header[80]);
-
- 
-	unsigned char * buffer;
-	unsigned int bufsize;
-	/* how big is it going to be including all mipmaps? */ 
-	bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize; 
-	buffer = (unsigned char*)malloc(bufsize * sizeof(unsigned char)); 
-	fread(buffer, 1, bufsize, fp); 
-	/* close the file pointer */ 
-	fclose(fp);
-
-	unsigned int components  = (fourCC == FOURCC_DXT1) ? 3 : 4; 
-	unsigned int format;
-	switch(fourCC) 
-	{ 
-	case FOURCC_DXT1: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; 
-		break; 
-	case FOURCC_DXT3: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; 
-		break; 
-	case FOURCC_DXT5: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; 
-		break; 
-	default: 
-		free(buffer); 
-		return 0; 
+	DDSHeader header;
+	memcpy(&header, data + 4, sizeof(header));
+	size_t offset = 4 + sizeof(DDSHeader);
+
+	if (header.size != sizeof(DDSHeader) || header.pixelFormat.size != sizeof(DDSPixelFormat) || header.width == 0 || header.height == 0) {
+		printf("%s has a corrupted DDS header\n", imagepath);
+		return false;
+	}
+	if (!(header.pixelFormat.flags & DDPF_FOURCC)) {
+		printf("%s is not block compressed, only BC1-BC5 and BC7 DDS files are supported\n", imagepath);
+		return false;
+	}
+	if (header.caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) {
+		printf("%s is a cube map or volume texture, which are not supported\n", imagepath);
+		return false;
 	}
 
-	// Create one OpenGL texture
-	GLuint textureID;
-	glGenTextures(1, &textureID);
+	image.blockSize = 0;
+	image.arraySize = 1;
+	if (header.pixelFormat.fourCC == FOURCC_DX10) {
+
+		/* DX10 extension follows the header and carries the real format */
+		DDSHeaderDX10 headerDX10;
+		if (fileSize < offset + sizeof(DDSHeaderDX10)) {
+			printf("%s has a truncated DX10 header\n", imagepath);
+			return false;
+		}
+		memcpy(&headerDX10, data + offset, sizeof(headerDX10));
+		offset += sizeof(DDSHeaderDX10);
+
+		if (headerDX10.resourceDimension != DDS_DIMENSION_TEXTURE2D || (headerDX10.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)) {
+			printf("%s is not a 2D texture, which is the only supported dimension\n", imagepath);
+			return false;
+		}
+		image.format = getDXGIFormat(headerDX10.dxgiFormat, &image.blockSize);
+		image.arraySize = headerDX10.arraySize > 0 ? headerDX10.arraySize : 1;
+	}
+	else {
+		image.format = getFourCCFormat(header.pixelFormat.fourCC, &image.blockSize);
+	}
 
-	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glPixelStorei(GL_UNPACK_ALIGNMENT,1);	
-	
-	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
-	unsigned int offset = 0;
+	if (image.format == 0) {
+		printf("%s has an unsupported DDS format\n", imagepath);
+		return false;
+	}
 
-	/* load the mipmaps */ 
-	for (unsigned int level = 0; level < mipMapCount && (width || height); ++level) 
-	{ 
-		unsigned int size = ((width+3)/4)*((height+3)/4)*blockSize; 
-		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height,  
-			0, size, buffer + offset); 
-	 
-		offset += size; 
-		width  /= 2; 
-		height /= 2; 
+	/* number of levels of the full chain is the upper bound, 0 in the header means just the base level */
+	unsigned int maxLevels = 1;
+	while (maxLevels < 32 && ((header.width >> maxLevels) > 0 || (header.height >> maxLevels) > 0)) maxLevels++;
+	image.mipMapCount = header.mipMapCount > 0 ? header.mipMapCount : 1;
+	if (image.mipMapCount > maxLevels) image.mipMapCount = maxLevels;
+	image.width = header.width;
+	image.height = header.height;
+
+	/* exact payload size: every array layer holds its whole mip chain */
+	image.layerSize = 0;
+	for (unsigned int level = 0; level < image.mipMapCount; ++level) {
+		unsigned int width = header.width >> level;
+		unsigned int height = header.height >> level;
+		image.layerSize += getLevelSize(width > 0 ? width : 1, height > 0 ? height : 1, image.blockSize);
+	}
+	if ((fileSize - offset) / image.arraySize < image.layerSize) {
+		printf("%s is truncated, expected %u layers of %u bytes\n", imagepath, image.arraySize, (unsigned int)image.layerSize);
+		return false;
+	}
 
-		// Deal with Non-Power-Of-Two textures. This code is not included in the webpage to reduce clutter.
-		if(width < 1) width = 1;
-		if(height < 1) height = 1;
+	image.payload = data + offset;
+	return true;
+}
 
-	} 
+const unsigned char * getDDSLevel(const DDSImage & image, unsigned int layer, unsigned int level,
+	unsigned int * width, unsigned int * height, size_t * size){
 
-	free(buffer); 
+	const unsigned char * levelData = image.payload + layer * image.layerSize;
+	for (unsigned int i = 0; i <= level; ++i) {
+		*width = image.width >> i;
+		*height = image.height >> i;
+		if (*width < 1) *width = 1;
+		if (*height < 1) *height = 1;
 
-	return textureID;
+		*size = getLevelSize(*width, *height, image.blockSize);
+		if (i < level) levelData += *size;
+	}
+	return levelData;
+}
+
+GLuint loadDDS(const char * imagepath){
 
+	/* map the whole file, levels are uploaded straight from the mapping */
+	MappedFile file;
+	if (!file.open(imagepath)){
+		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath); getchar(); 
+		return 0;
+	}
+
+	DDSImage image;
+	if (!parseDDS(imagepath, file.getData(), file.getSize(), image)) {
+		return 0;
+	}
 
-}
\ No newline at end of file
+	// Create one OpenGL texture
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+
+	// Block rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+
+	unsigned int width, height;
+	size_t size;
+	if (image.arraySize == 1) {
+
+		// "Bind" the newly created texture : all future texture functions will modify this texture
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.mipMapCount - 1);
+
+		/* load the mipmaps straight from the mapped file */ 
+		for (unsigned int level = 0; level < image.mipMapCount; ++level) 
+		{ 
+			const unsigned char * levelData = getDDSLevel(image, 0, level, &width, &height, &size);
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, image.format, width, height,  
+				0, (GLsizei)size, levelData); 
+		}
+	}
+	else {
+
+		// Texture arrays are allocated once and filled layer by layer, level by level
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, image.mipMapCount, image.format, image.width, image.height, image.arraySize);
+
+		for (unsigned int layer = 0; layer < image.arraySize; ++layer)
+		{
+			for (unsigned int level = 0; level < image.mipMapCount; ++level)
+			{
+				const unsigned char * levelData = getDDSLevel(image, layer, level, &width, &height, &size);
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+					image.format, (GLsizei)size, levelData);
+			}
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+
+	return textureID;
+}
@@ -9,7 +9,27 @@ GLuint loadBMP_custom(const char * imagepath);
 //// Load a .TGA file using GLFW's own loader
 //GLuint loadTGA_glfw(const char * imagepath);
 
-// Load a .DDS file using GLFW's own loader
+// Block compressed image of a .DDS file, its levels point into the file contents
+struct DDSImage {
+	GLenum format;                  // Compressed OpenGL internal format
+	unsigned int blockSize;         // Bytes per 4x4 block
+	unsigned int width;             // Size of the base level
+	unsigned int height;
+	unsigned int arraySize;         // Number of array layers, 1 for plain 2D textures
+	unsigned int mipMapCount;       // Number of levels of every layer
+	size_t layerSize;               // Bytes of one layer with all its levels
+	const unsigned char * payload;  // Levels of all layers, layer after layer
+};
+
+// Validate contents of a .DDS file and describe its levels without copying them. Makes no OpenGL calls, so it can run on any thread.
+bool parseDDS(const char * imagepath, const unsigned char * data, size_t fileSize, DDSImage & image);
+
+// Get level of a layer of a parsed .DDS image together with its size in texels and bytes
+const unsigned char * getDDSLevel(const DDSImage & image, unsigned int layer, unsigned int level,
+	unsigned int * width, unsigned int * height, size_t * size);
+
+// Load a block compressed .DDS file (BC1-BC5 and BC7, legacy or DX10 header) with all its mipmaps.
+// Files with DX10 array size above 1 are loaded as GL_TEXTURE_2D_ARRAY, others as GL_TEXTURE_2D.
 GLuint loadDDS(const char * imagepath);
 
 
@@ -0,0 +1,172 @@
+// Vertex indexer welding identical vertices of a triangle soup.
+// Unique vertices are found with an open addressing hash table (linear probing, at most half full)
+// over the packed attributes, so indexing is linear in the number of vertices.
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "vboindexer.hpp"
+
+namespace {
+
+	// Marks free slot of the hash table
+	const uint32_t EMPTY_SLOT = 0xFFFFFFFF;
+
+	// All attributes of a vertex, packed to be hashed and compared at once
+	template <int NUM_FLOATS>
+	struct PackedVertex {
+		float values[NUM_FLOATS];
+	};
+
+	inline uint32_t rotateLeft(uint32_t value, int bits){
+		return (value << bits) | (value >> (32 - bits));
+	}
+
+	// MurmurHash3 over the bits of the floats. Adding zero turns -0 into +0, so that both hash the same as they compare equal.
+	template <int NUM_FLOATS>
+	uint32_t hashVertex(const PackedVertex<NUM_FLOATS> & vertex){
+		uint32_t hash = 0;
+		for( int i = 0; i < NUM_FLOATS; i++ ){
+			const float value = vertex.values[i] + 0.0f;
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+
+			bits = rotateLeft(bits * 0xCC9E2D51u, 15) * 0x1B873593u;
+			hash = rotateLeft(hash ^ bits, 13) * 5 + 0xE6546B64u;
+		}
+
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35u;
+		return hash ^ (hash >> 16);
+	}
+
+	template <int NUM_FLOATS>
+	bool isSameVertex(const PackedVertex<NUM_FLOATS> & a, const PackedVertex<NUM_FLOATS> & b){
+		for( int i = 0; i < NUM_FLOATS; i++ ){
+			if( a.values[i] != b.values[i] )
+				return false;
+		}
+		return true;
+	}
+
+	// Welds numVertices vertices : packVertex(i, packed) packs input vertex i, addVertex(i) appends it to the outputs
+	// as a new unique vertex, mergeVertex(i, index) is called for input vertex i equal to already added vertex index.
+	template <int NUM_FLOATS, typename PackVertex, typename AddVertex, typename MergeVertex>
+	void weldVertices(size_t numVertices, PackVertex packVertex, AddVertex addVertex, MergeVertex mergeVertex, VertexIndices & out_indices){
+		size_t capacity = 16;
+		while( capacity < numVertices * 2 )
+			capacity *= 2;
+		const size_t mask = capacity - 1;
+
+		std::vector<uint32_t> table(capacity, EMPTY_SLOT);
+		std::vector< PackedVertex<NUM_FLOATS> > uniqueVertices;
+		std::vector<uint32_t> indices(numVertices);
+
+		for( size_t i = 0; i < numVertices; i++ ){
+			PackedVertex<NUM_FLOATS> vertex;
+			packVertex(i, vertex);
+
+			size_t slot = hashVertex(vertex) & mask;
+			while( table[slot] != EMPTY_SLOT && !isSameVertex(uniqueVertices[table[slot]], vertex) )
+				slot = (slot + 1) & mask;
+
+			if( table[slot] == EMPTY_SLOT ){
+				// A new vertex, add it to the output data
+				table[slot] = uint32_t(uniqueVertices.size());
+				uniqueVertices.push_back(vertex);
+				addVertex(i);
+			}else{
+				// A similar vertex is already in the VBO, use it instead !
+				mergeVertex(i, table[slot]);
+			}
+			indices[i] = table[slot];
+		}
+
+		// Narrow the indices, if all vertices can be addressed with 16 bits
+		out_indices.is32Bit = uniqueVertices.size() > 0x10000;
+		out_indices.indices16.clear();
+		out_indices.indices32.clear();
+		if( out_indices.is32Bit ){
+			out_indices.indices32.swap(indices);
+		}else{
+			out_indices.indices16.assign(indices.begin(), indices.end());
+		}
+	}
+
+} // namespace
+
+void indexVBO(
+	const std::vector<glm::vec3> & in_vertices,
+	const std::vector<glm::vec2> & in_uvs,
+	const std::vector<glm::vec3> & in_normals,
+
+	VertexIndices & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	out_vertices.clear();
+	out_uvs     .clear();
+	out_normals .clear();
+
+	weldVertices<8>(in_vertices.size(),
+		[&](size_t i, PackedVertex<8> & vertex){
+			memcpy(vertex.values + 0, &in_vertices[i], sizeof(glm::vec3));
+			memcpy(vertex.values + 3, &in_uvs[i], sizeof(glm::vec2));
+			memcpy(vertex.values + 5, &in_normals[i], sizeof(glm::vec3));
+		},
+		[&](size_t i){
+			out_vertices.push_back(in_vertices[i]);
+			out_uvs     .push_back(in_uvs[i]);
+			out_normals .push_back(in_normals[i]);
+		},
+		[](size_t, uint32_t){},
+		out_indices);
+}
+
+void indexVBO_TBN(
+	const std::vector<glm::vec3> & in_vertices,
+	const std::vector<glm::vec2> & in_uvs,
+	const std::vector<glm::vec3> & in_normals,
+	const std::vector<glm::vec3> & in_tangents,
+	const std::vector<glm::vec3> & in_bitangents,
+
+	VertexIndices & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents
+){
+	out_vertices  .clear();
+	out_uvs       .clear();
+	out_normals   .clear();
+	out_tangents  .clear();
+	out_bitangents.clear();
+
+	// Tangents are per triangle, so they are not part of the key. Welded vertices average them instead,
+	// the sums are normalized in the shader.
+	weldVertices<8>(in_vertices.size(),
+		[&](size_t i, PackedVertex<8> & vertex){
+			memcpy(vertex.values + 0, &in_vertices[i], sizeof(glm::vec3));
+			memcpy(vertex.values + 3, &in_uvs[i], sizeof(glm::vec2));
+			memcpy(vertex.values + 5, &in_normals[i], sizeof(glm::vec3));
+		},
+		[&](size_t i){
+			out_vertices  .push_back(in_vertices[i]);
+			out_uvs       .push_back(in_uvs[i]);
+			out_normals   .push_back(in_normals[i]);
+			out_tangents  .push_back(in_tangents[i]);
+			out_bitangents.push_back(in_bitangents[i]);
+		},
+		[&](size_t i, uint32_t index){
+			out_tangents  [index] += in_tangents[i];
+			out_bitangents[index] += in_bitangents[i];
+		},
+		out_indices);
+}
@@ -1,26 +1,42 @@
 #ifndef VBOINDEXER_HPP
 #define VBOINDEXER_HPP
 
+#include <cstdint>
+#include <vector>
+
+// Indices of a welded mesh. 16 bit indices are used while they can address all vertices, 32 bit ones otherwise.
+struct VertexIndices {
+	std::vector<uint16_t> indices16; // Filled, if is32Bit is false
+	std::vector<uint32_t> indices32; // Filled, if is32Bit is true
+	bool is32Bit = false;
+
+	size_t size() const { return is32Bit ? indices32.size() : indices16.size(); }
+	size_t getIndexSize() const { return is32Bit ? sizeof(uint32_t) : sizeof(uint16_t); }
+	const void * data() const { return is32Bit ? static_cast<const void *>(indices32.data()) : static_cast<const void *>(indices16.data()); }
+	uint32_t operator[](size_t i) const { return is32Bit ? indices32[i] : indices16[i]; }
+};
+
+// Welds identical (position, uv, normal) vertices of a triangle soup, outputs are cleared first
 void indexVBO(
-	std::vector<glm::vec3> & in_vertices,
-	std::vector<glm::vec2> & in_uvs,
-	std::vector<glm::vec3> & in_normals,
+	const std::vector<glm::vec3> & in_vertices,
+	const std::vector<glm::vec2> & in_uvs,
+	const std::vector<glm::vec3> & in_normals,
 
-	std::vector<unsigned short> & out_indices,
+	VertexIndices & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 );
 
-
+// Same as indexVBO, tangents and bitangents of welded vertices are summed up
 void indexVBO_TBN(
-	std::vector<glm::vec3> & in_vertices,
-	std::vector<glm::vec2> & in_uvs,
-	std::vector<glm::vec3> & in_normals,
-	std::vector<glm::vec3> & in_tangents,
-	std::vector<glm::vec3> & in_bitangents,
+	const std::vector<glm::vec3> & in_vertices,
+	const std::vector<glm::vec2> & in_uvs,
+	const std::vector<glm::vec3> & in_normals,
+	const std::vector<glm::vec3> & in_tangents,
+	const std::vector<glm::vec3> & in_bitangents,
 
-	std::vector<unsigned short> & out_indices,
+	VertexIndices & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals,
@@ -28,4 +44,4 @@ void indexVBO_TBN(
 	std::vector<glm::vec3> & out_bitangents
 );
 
-#endif
\ No newline at end of file
+#endif
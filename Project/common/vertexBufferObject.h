@@ -49,6 +49,13 @@ public:
 	*/
 	void uploadDataToGPU(GLenum usageHint);
 
+	/** \brief Uploads given data straight to the GPU memory, bypassing the in-memory buffer (e.g. from a memory mapped file).
+	*   \param usageHint     Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+	*   \param ptrData       Pointer to the raw data
+	*   \param dataSizeBytes Size of the data (in bytes)
+	*/
+	void uploadDataToGPU(GLenum usageHint, const void* ptrData, size_t dataSizeBytes);
+
 	void* mapBufferToMemory(GLenum usageHint) const;
 
 	void* mapSubBufferToMemory(GLenum usageHint, size_t offset, size_t length) const;
@@ -0,0 +1,455 @@
+// STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "common/objloader.hpp"
+#include "common/vboindexer.hpp"
+#include "cookedMesh.h"
+#include "meshOptimizer.h"
+
+namespace {
+
+	const char MAGIC[4] = { 'M', 'S', 'C', 'H' };
+	const uint32_t VERSION = 3;
+	const uint32_t FLAG_32BIT_INDICES = 1;
+	const uint32_t FLAG_OVERDRAW_OPTIMIZED = 2;
+	const size_t STREAM_ALIGNMENT = 16;
+
+	struct StreamEntry
+	{
+		uint64_t offset;
+		uint64_t numBytes;
+	};
+	static_assert(sizeof(StreamEntry) == 16, "Cache stream entry must not contain padding");
+
+	struct FileHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t sourceSize;
+		int64_t sourceModificationTime;
+		uint32_t flags;
+		uint32_t numVertices;
+		uint32_t numIndices;
+		uint32_t numSubmeshes;
+		float boundsMin[3];
+		float boundsMax[3];
+		StreamEntry streams[CookedMesh::NUM_STREAMS];
+		uint64_t submeshTableOffset;
+	};
+	static_assert(sizeof(FileHeader) == 144, "Cache header must not contain padding");
+
+	struct SubmeshEntry
+	{
+		char material[CookedMesh::MAX_MATERIAL_NAME_LENGTH + 1];
+		uint32_t firstIndex;
+		uint32_t numIndices;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+	static_assert(sizeof(SubmeshEntry) == 96, "Cache submesh entry must not contain padding");
+
+	size_t alignUp(size_t value)
+	{
+		return (value + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+	}
+
+	size_t getStreamElementSize(CookedMesh::Stream stream, bool is32BitIndices)
+	{
+		switch (stream)
+		{
+		case CookedMesh::Stream::Positions: return sizeof(glm::vec3);
+		case CookedMesh::Stream::TextureCoordinates: return sizeof(glm::vec2);
+		case CookedMesh::Stream::Normals: return sizeof(glm::vec3);
+		case CookedMesh::Stream::Indices: return is32BitIndices ? sizeof(uint32_t) : sizeof(uint16_t);
+		}
+		return 0;
+	}
+
+	template <typename IndexType>
+	bool areIndicesInRange(const unsigned char* indices, uint32_t numIndices, uint32_t numVertices)
+	{
+		// Maximum without early exit, so the loop vectorizes, number of vertices is never zero
+		IndexType maxIndex = 0;
+		for (uint32_t i = 0; i < numIndices; i++)
+		{
+			IndexType index;
+			memcpy(&index, indices + sizeof(IndexType) * i, sizeof(index));
+			maxIndex = std::max(maxIndex, index);
+		}
+		return maxIndex < numVertices;
+	}
+
+} // namespace
+
+const char* CookedMesh::FILE_EXTENSION = ".meshcache";
+const float CookedMesh::OVERDRAW_THRESHOLD = 1.05f;
+
+std::string CookedMesh::getCachePath(const std::string& sourcePath)
+{
+	return sourcePath + FILE_EXTENSION;
+}
+
+bool CookedMesh::loadOrCook(const std::string& sourcePath, bool optimizeOverdraw, bool forceCook)
+{
+	SourceVersion source;
+	if (!getFileStamp(sourcePath, source.stamp))
+	{
+		std::cout << "Failure to open mesh source " << sourcePath << std::endl;
+		return false;
+	}
+
+	// Source with the stamp, that the cache was cooked from, is not read at all
+	const auto cachePath = getCachePath(sourcePath);
+	if (!forceCook && load(cachePath, source, optimizeOverdraw)) {
+		return true;
+	}
+
+	MappedFile sourceFile;
+	if (!sourceFile.open(sourcePath))
+	{
+		std::cout << "Failure to open mesh source " << sourcePath << std::endl;
+		return false;
+	}
+
+	source.hash = fnv1a64(sourceFile.getData(), sourceFile.getSize());
+	source.isHashed = true;
+	sourceFile.close();
+
+	// Touched but unchanged source (e.g. checked out again) keeps its cache, which takes over the new stamp
+	if (!forceCook && load(cachePath, source, optimizeOverdraw))
+	{
+		if (!restamp(cachePath, source.stamp)) {
+			std::cout << "Failure to update mesh cache " << cachePath << std::endl;
+		}
+		return true;
+	}
+
+	if (!cook(sourcePath, source, optimizeOverdraw)) {
+		return false;
+	}
+
+	// Mesh is usable even if cache cannot be written, next run just cooks it again
+	if (!save(cachePath)) {
+		std::cout << "Failure to write mesh cache " << cachePath << std::endl;
+	}
+	return true;
+}
+
+bool CookedMesh::load(const std::string& cachePath, const SourceVersion& source, bool optimizeOverdraw)
+{
+	_cookedBytes.clear();
+	if (!_file.open(cachePath)) {
+		return false;
+	}
+
+	if (!parse(_file.getData(), _file.getSize(), source, optimizeOverdraw))
+	{
+		_file.close();
+		return false;
+	}
+	return true;
+}
+
+bool CookedMesh::cook(const std::string& sourcePath, const SourceVersion& source, bool optimizeOverdraw)
+{
+	_file.close();
+	_cookedBytes.clear();
+	_submeshes.clear();
+
+	std::vector<glm::vec3> soupPositions, soupNormals;
+	std::vector<glm::vec2> soupTextureCoordinates;
+	std::vector<ObjSubmesh> objSubmeshes;
+	if (!loadOBJ(sourcePath.c_str(), soupPositions, soupTextureCoordinates, soupNormals, objSubmeshes) || soupPositions.empty()) {
+		return false;
+	}
+
+	// Weld the triangle soup, corners with equal attributes share one vertex
+	VertexIndices indices;
+	std::vector<glm::vec3> positions, normals;
+	std::vector<glm::vec2> textureCoordinates;
+	indexVBO(soupPositions, soupTextureCoordinates, soupNormals, indices, positions, textureCoordinates, normals);
+
+	// Triangles are reordered within their submeshes, so that submesh ranges stay valid
+	std::vector<uint32_t> optimizedIndices(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		optimizedIndices[i] = indices[i];
+	}
+
+	const auto statisticsBefore = mesh_optimizer::analyzeVertexCache(optimizedIndices.data(), optimizedIndices.size(), positions.size());
+	for (const auto& objSubmesh : objSubmeshes)
+	{
+		auto submeshIndices = optimizedIndices.data() + objSubmesh.firstVertex;
+		mesh_optimizer::optimizeVertexCache(submeshIndices, objSubmesh.numVertices, positions.size());
+		if (optimizeOverdraw) {
+			mesh_optimizer::optimizeOverdraw(submeshIndices, objSubmesh.numVertices, positions.data(), positions.size(), OVERDRAW_THRESHOLD);
+		}
+	}
+
+	size_t numUsedVertices;
+	const auto remap = mesh_optimizer::optimizeVertexFetch(optimizedIndices.data(), optimizedIndices.size(), positions.size(), numUsedVertices);
+	positions = mesh_optimizer::remapVertices(positions, remap, numUsedVertices);
+	textureCoordinates = mesh_optimizer::remapVertices(textureCoordinates, remap, numUsedVertices);
+	normals = mesh_optimizer::remapVertices(normals, remap, numUsedVertices);
+
+	const auto statisticsAfter = mesh_optimizer::analyzeVertexCache(optimizedIndices.data(), optimizedIndices.size(), positions.size());
+	std::cout << "Optimized mesh " << sourcePath << ": ACMR " << statisticsBefore.acmr << " -> " << statisticsAfter.acmr
+		<< ", ATVR " << statisticsBefore.atvr << " -> " << statisticsAfter.atvr << std::endl;
+
+	indices.is32Bit = numUsedVertices > 0x10000;
+	indices.indices16.clear();
+	indices.indices32.clear();
+	if (indices.is32Bit) {
+		indices.indices32.swap(optimizedIndices);
+	}
+	else {
+		indices.indices16.assign(optimizedIndices.begin(), optimizedIndices.end());
+	}
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.sourceHash = source.hash;
+	header.sourceSize = source.stamp.size;
+	header.sourceModificationTime = source.stamp.modificationTime;
+	header.flags = (indices.is32Bit ? FLAG_32BIT_INDICES : 0) | (optimizeOverdraw ? FLAG_OVERDRAW_OPTIMIZED : 0);
+	header.numVertices = uint32_t(positions.size());
+	header.numIndices = uint32_t(indices.size());
+	header.numSubmeshes = uint32_t(objSubmeshes.size());
+
+	const auto bounds = BoundingBox::fromPoints(positions.data(), positions.size(), sizeof(glm::vec3));
+	memcpy(header.boundsMin, &bounds.min, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &bounds.max, sizeof(header.boundsMax));
+
+	// Vertex streams follow each other without padding, so that they form one planar vertex buffer
+	const void* streamData[NUM_STREAMS] = { positions.data(), textureCoordinates.data(), normals.data(), indices.data() };
+	header.submeshTableOffset = alignUp(sizeof(FileHeader));
+	auto offset = alignUp(size_t(header.submeshTableOffset) + sizeof(SubmeshEntry) * objSubmeshes.size());
+	for (int i = 0; i < NUM_STREAMS; i++)
+	{
+		const auto stream = Stream(i);
+		if (stream == Stream::Indices) {
+			offset = alignUp(offset);
+		}
+
+		const auto numElements = stream == Stream::Indices ? indices.size() : positions.size();
+		header.streams[i].offset = offset;
+		header.streams[i].numBytes = numElements * getStreamElementSize(stream, indices.is32Bit);
+		offset += size_t(header.streams[i].numBytes);
+	}
+
+	_cookedBytes.resize(offset);
+	auto bytes = _cookedBytes.data();
+	memcpy(bytes, &header, sizeof(header));
+	for (int i = 0; i < NUM_STREAMS; i++) {
+		memcpy(bytes + header.streams[i].offset, streamData[i], size_t(header.streams[i].numBytes));
+	}
+
+	// Submeshes are ranges of the triangle soup, which map one to one to ranges of the index buffer
+	for (size_t i = 0; i < objSubmeshes.size(); i++)
+	{
+		const auto& objSubmesh = objSubmeshes[i];
+		SubmeshEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		objSubmesh.material.copy(entry.material, MAX_MATERIAL_NAME_LENGTH);
+		entry.firstIndex = uint32_t(objSubmesh.firstVertex);
+		entry.numIndices = uint32_t(objSubmesh.numVertices);
+
+		BoundingBox submeshBounds;
+		for (auto j = entry.firstIndex; j < entry.firstIndex + entry.numIndices; j++) {
+			submeshBounds.include(positions[indices[j]]);
+		}
+		memcpy(entry.boundsMin, &submeshBounds.min, sizeof(entry.boundsMin));
+		memcpy(entry.boundsMax, &submeshBounds.max, sizeof(entry.boundsMax));
+		memcpy(bytes + header.submeshTableOffset + sizeof(SubmeshEntry) * i, &entry, sizeof(entry));
+	}
+
+	return parse(bytes, _cookedBytes.size(), source, optimizeOverdraw);
+}
+
+bool CookedMesh::save(const std::string& cachePath) const
+{
+	if (_cookedBytes.empty()) {
+		return false;
+	}
+
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(_cookedBytes.data()), std::streamsize(_cookedBytes.size()));
+	return bool(file);
+}
+
+bool CookedMesh::restamp(const std::string& cachePath, const FileStamp& sourceStamp)
+{
+	// Mapping of the cache cannot be written, the cache is copied into memory, stamped and written again
+	_cookedBytes.assign(_file.getData(), _file.getData() + _file.getSize());
+	_file.close();
+
+	FileHeader header;
+	memcpy(&header, _cookedBytes.data(), sizeof(header));
+	header.sourceSize = sourceStamp.size;
+	header.sourceModificationTime = sourceStamp.modificationTime;
+	memcpy(_cookedBytes.data(), &header, sizeof(header));
+
+	SourceVersion source;
+	source.stamp = sourceStamp;
+	parse(_cookedBytes.data(), _cookedBytes.size(), source, (header.flags & FLAG_OVERDRAW_OPTIMIZED) != 0);
+	return save(cachePath);
+}
+
+uint32_t CookedMesh::getNumVertices() const
+{
+	return _numVertices;
+}
+
+uint32_t CookedMesh::getNumIndices() const
+{
+	return _numIndices;
+}
+
+GLenum CookedMesh::getIndexType() const
+{
+	return _is32BitIndices ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+}
+
+size_t CookedMesh::getIndexSize() const
+{
+	return getStreamElementSize(Stream::Indices, _is32BitIndices);
+}
+
+const glm::vec3* CookedMesh::getPositions() const
+{
+	return reinterpret_cast<const glm::vec3*>(_streams[int(Stream::Positions)]);
+}
+
+const glm::vec2* CookedMesh::getTextureCoordinates() const
+{
+	return reinterpret_cast<const glm::vec2*>(_streams[int(Stream::TextureCoordinates)]);
+}
+
+const glm::vec3* CookedMesh::getNormals() const
+{
+	return reinterpret_cast<const glm::vec3*>(_streams[int(Stream::Normals)]);
+}
+
+const void* CookedMesh::getIndices() const
+{
+	return _streams[int(Stream::Indices)];
+}
+
+const BoundingBox& CookedMesh::getBounds() const
+{
+	return _bounds;
+}
+
+const std::vector<CookedMesh::Submesh>& CookedMesh::getSubmeshes() const
+{
+	return _submeshes;
+}
+
+void CookedMesh::uploadVertices(VertexBufferObject& vbo, GLenum usageHint) const
+{
+	vbo.bindVBO(GL_ARRAY_BUFFER);
+	vbo.uploadDataToGPU(usageHint, _streams[int(Stream::Positions)], _numVertexBytes);
+}
+
+void CookedMesh::uploadIndices(VertexBufferObject& vbo, GLenum usageHint) const
+{
+	vbo.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+	vbo.uploadDataToGPU(usageHint, _streams[int(Stream::Indices)], _numIndices * getIndexSize());
+}
+
+bool CookedMesh::parse(const unsigned char* bytes, size_t numBytes, const SourceVersion& source, bool optimizeOverdraw)
+{
+	_submeshes.clear();
+	if (numBytes < sizeof(FileHeader)) {
+		return false;
+	}
+
+	FileHeader header;
+	memcpy(&header, bytes, sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+		return false;
+	}
+
+	// Stale cache of changed source model or cooked with other optimizations
+	const auto isUpToDate = source.isHashed ? header.sourceHash == source.hash
+		: header.sourceSize == source.stamp.size && header.sourceModificationTime == source.stamp.modificationTime;
+	const auto isOverdrawOptimized = (header.flags & FLAG_OVERDRAW_OPTIMIZED) != 0;
+	if (!isUpToDate || isOverdrawOptimized != optimizeOverdraw) {
+		return false;
+	}
+
+	const auto is32BitIndices = (header.flags & FLAG_32BIT_INDICES) != 0;
+	if (header.numVertices == 0 || header.numIndices % 3 != 0 || (!is32BitIndices && header.numVertices > 0x10000)) {
+		return false;
+	}
+
+	// Every stream has to have exact size and lie in the file, vertex streams have to follow each other
+	for (int i = 0; i < NUM_STREAMS; i++)
+	{
+		const auto stream = Stream(i);
+		const auto& entry = header.streams[i];
+		const auto numElements = stream == Stream::Indices ? header.numIndices : header.numVertices;
+		if (entry.numBytes != uint64_t(numElements) * getStreamElementSize(stream, is32BitIndices)
+			|| entry.offset % sizeof(float) != 0 || entry.offset > numBytes || entry.numBytes > numBytes - entry.offset) {
+			return false;
+		}
+
+		if (stream != Stream::Positions && stream != Stream::Indices
+			&& entry.offset != header.streams[i - 1].offset + header.streams[i - 1].numBytes) {
+			return false;
+		}
+	}
+
+	// Out of range index would make the GPU fetch vertices outside of the buffer
+	const auto indices = bytes + header.streams[int(Stream::Indices)].offset;
+	const auto isIndexValid = is32BitIndices ? areIndicesInRange<uint32_t>(indices, header.numIndices, header.numVertices)
+		: areIndicesInRange<uint16_t>(indices, header.numIndices, header.numVertices);
+	if (!isIndexValid) {
+		return false;
+	}
+
+	if (header.submeshTableOffset > numBytes || header.numSubmeshes > (numBytes - header.submeshTableOffset) / sizeof(SubmeshEntry)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.numSubmeshes; i++)
+	{
+		SubmeshEntry entry;
+		memcpy(&entry, bytes + header.submeshTableOffset + sizeof(SubmeshEntry) * i, sizeof(entry));
+		if (entry.firstIndex > header.numIndices || entry.numIndices > header.numIndices - entry.firstIndex)
+		{
+			_submeshes.clear();
+			return false;
+		}
+
+		Submesh submesh;
+		submesh.material.assign(entry.material, std::find(entry.material, entry.material + MAX_MATERIAL_NAME_LENGTH, '\0'));
+		submesh.firstIndex = entry.firstIndex;
+		submesh.numIndices = entry.numIndices;
+		memcpy(&submesh.bounds.min, entry.boundsMin, sizeof(entry.boundsMin));
+		memcpy(&submesh.bounds.max, entry.boundsMax, sizeof(entry.boundsMax));
+		_submeshes.push_back(submesh);
+	}
+
+	for (int i = 0; i < NUM_STREAMS; i++) {
+		_streams[i] = bytes + header.streams[i].offset;
+	}
+	_numVertices = header.numVertices;
+	_numIndices = header.numIndices;
+	_is32BitIndices = is32BitIndices;
+	_numVertexBytes = size_t(header.streams[int(Stream::Normals)].offset + header.streams[int(Stream::Normals)].numBytes
+		- header.streams[int(Stream::Positions)].offset);
+	memcpy(&_bounds.min, header.boundsMin, sizeof(header.boundsMin));
+	memcpy(&_bounds.max, header.boundsMax, sizeof(header.boundsMax));
+	return true;
+}
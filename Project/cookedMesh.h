@@ -0,0 +1,144 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include <glad/glad.h>
+
+// Project
+#include "boundingVolumes.h"
+#include "common/vertexBufferObject.h"
+#include "mappedFile.h"
+
+/**
+* Indexed mesh cooked from an OBJ model, stored in a binary cache file next to its source
+* (source path + ".meshcache"). The cache is memory mapped and its streams are uploaded as they are,
+* so neither parsing nor vertex welding happens at runtime. The cache stores size, modification time
+* and hash of the source model. While size and modification time match, the source is not read at all,
+* otherwise it is hashed and a cache with different hash is stale and gets cooked again from the source.
+*
+* Cooking also optimizes the mesh for rendering: triangles of every submesh are reordered for the
+* vertex cache (and optionally for less overdraw), then vertices are renumbered in fetch order.
+*
+* Cache layout (little endian): header with stream table and bounding box, submesh table, vertex
+* streams (positions, texture coordinates, normals) back to back, so that together they form
+* a planar vertex buffer, and index buffer. Submesh table and streams start at 16 byte aligned offsets.
+*/
+class CookedMesh
+{
+public:
+	/** \brief Streams of the cache, in the order they are stored. */
+	enum class Stream : uint32_t
+	{
+		Positions = 0,
+		TextureCoordinates = 1,
+		Normals = 2,
+		Indices = 3
+	};
+
+	static const int NUM_STREAMS = 4; //!< Number of streams every cache has
+	static const int MAX_MATERIAL_NAME_LENGTH = 63; //!< Longer material names are truncated
+
+	/** \brief Range of indices drawn with one material. */
+	struct Submesh
+	{
+		std::string material; //!< Material name, empty if the model uses none
+		uint32_t firstIndex; //!< First index of the range
+		uint32_t numIndices; //!< Number of indices, three per triangle
+		BoundingBox bounds; //!< Bounding box of the triangles in model space
+	};
+
+	/** \brief Version of the source model, the hash is computed only when the stamp does not match the cache. */
+	struct SourceVersion
+	{
+		FileStamp stamp; //!< Size and modification time of the source
+		bool isHashed = false; //!< Flag telling, if hash is valid and caches are validated by hash instead of stamp
+		uint64_t hash = 0; //!< FNV-1a hash of the source contents
+	};
+
+	static const char* FILE_EXTENSION; //!< Extension appended to source path to get cache path
+
+	/** \brief  Gets path of cache file of given source model. */
+	static std::string getCachePath(const std::string& sourcePath);
+
+	static const float OVERDRAW_THRESHOLD; //!< Allowed vertex cache miss ratio growth for overdraw ordering
+
+	/** \brief  Loads cache of source model. If it is missing or stale (or cooking is forced), cooks it from the source and saves it.
+	*   \return True, if mesh is ready for upload.
+	*/
+	bool loadOrCook(const std::string& sourcePath, bool optimizeOverdraw = true, bool forceCook = false);
+
+	/** \brief  Maps cache file and validates it against stamp of its source, or its hash, if the source has been hashed.
+	*   \return True, if cache is valid and up to date.
+	*/
+	bool load(const std::string& cachePath, const SourceVersion& source, bool optimizeOverdraw);
+
+	/** \brief  Loads OBJ model, welds its vertices, optimizes them for rendering and lays out the cache in memory.
+	*   Vertex cache efficiency before and after optimization is reported on standard output.
+	*   \param  source  Version of the source, must be hashed
+	*/
+	bool cook(const std::string& sourcePath, const SourceVersion& source, bool optimizeOverdraw);
+
+	/** \brief  Writes cooked mesh to a cache file. */
+	bool save(const std::string& cachePath) const;
+
+	/** \brief  Gets number of unique vertices. */
+	uint32_t getNumVertices() const;
+
+	/** \brief  Gets number of indices, three per triangle. */
+	uint32_t getNumIndices() const;
+
+	/** \brief  Gets type of indices, GL_UNSIGNED_SHORT if 16 bits address all vertices, GL_UNSIGNED_INT otherwise. */
+	GLenum getIndexType() const;
+
+	/** \brief  Gets size of one index in bytes. */
+	size_t getIndexSize() const;
+
+	/** \brief  Gets vertex positions, pointing into the cache memory. */
+	const glm::vec3* getPositions() const;
+
+	/** \brief  Gets vertex texture coordinates, pointing into the cache memory. */
+	const glm::vec2* getTextureCoordinates() const;
+
+	/** \brief  Gets vertex normals, pointing into the cache memory. */
+	const glm::vec3* getNormals() const;
+
+	/** \brief  Gets indices of type getIndexType(), pointing into the cache memory. */
+	const void* getIndices() const;
+
+	/** \brief  Gets bounding box of all vertices in model space. */
+	const BoundingBox& getBounds() const;
+
+	/** \brief  Gets submeshes in the order of the index buffer. */
+	const std::vector<Submesh>& getSubmeshes() const;
+
+	/** \brief  Uploads all vertex streams straight from the cache memory in planar layout (positions, texture coordinates, normals).
+	*   The VBO must be created, it is bound as GL_ARRAY_BUFFER.
+	*/
+	void uploadVertices(VertexBufferObject& vbo, GLenum usageHint = GL_STATIC_DRAW) const;
+
+	/** \brief  Uploads index buffer straight from the cache memory. The VBO must be created, it is bound as GL_ELEMENT_ARRAY_BUFFER. */
+	void uploadIndices(VertexBufferObject& vbo, GLenum usageHint = GL_STATIC_DRAW) const;
+
+private:
+	MappedFile _file; // Mapped cache file, when loaded from disk
+	std::vector<unsigned char> _cookedBytes; // Cache contents, when cooked in memory
+	uint32_t _numVertices = 0; // Number of unique vertices
+	uint32_t _numIndices = 0; // Number of indices
+	bool _is32BitIndices = false; // Flag telling, if indices are 32 bit wide
+	const unsigned char* _streams[NUM_STREAMS] = {}; // Streams pointing into the mapped file or cooked bytes
+	size_t _numVertexBytes = 0; // Size of all vertex streams together
+	BoundingBox _bounds; // Bounding box of all vertices
+	std::vector<Submesh> _submeshes; // Index ranges by material
+
+	bool parse(const unsigned char* bytes, size_t numBytes, const SourceVersion& source, bool optimizeOverdraw);
+	bool restamp(const std::string& cachePath, const FileStamp& sourceStamp);
+};
+
+#endif
@@ -0,0 +1,295 @@
+// STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Project
+#include "cookedTexture.h"
+#include "stb_image.h"
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace {
+
+	const char MAGIC[4] = { 'T', 'X', 'C', 'H' };
+	const uint32_t VERSION = 1;
+	const uint32_t FLAG_FLIPPED_VERTICALLY = 1;
+	const uint32_t MAX_LEVELS = 32;
+	const size_t LEVEL_ALIGNMENT = 16;
+
+	struct FileHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint32_t format;
+		uint32_t flags;
+		uint32_t width;
+		uint32_t height;
+		uint32_t numLevels;
+		uint32_t reserved;
+	};
+	static_assert(sizeof(FileHeader) == 40, "Cache header must not contain padding");
+
+	struct LevelEntry
+	{
+		uint64_t offset;
+		uint64_t numBytes;
+		uint32_t width;
+		uint32_t height;
+	};
+	static_assert(sizeof(LevelEntry) == 24, "Cache level entry must not contain padding");
+
+	size_t alignUp(size_t value)
+	{
+		return (value + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+	}
+
+	// Halves RGBA8 image with 2x2 box filter, last row / column is repeated for odd sizes
+	void downsample(const unsigned char* source, uint32_t sourceWidth, uint32_t sourceHeight,
+		unsigned char* destination, uint32_t width, uint32_t height)
+	{
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const auto y0 = std::min(y * 2, sourceHeight - 1);
+			const auto y1 = std::min(y * 2 + 1, sourceHeight - 1);
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const auto x0 = std::min(x * 2, sourceWidth - 1);
+				const auto x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				for (uint32_t channel = 0; channel < 4; channel++)
+				{
+					const auto sum = source[(y0 * sourceWidth + x0) * 4 + channel] + source[(y0 * sourceWidth + x1) * 4 + channel]
+						+ source[(y1 * sourceWidth + x0) * 4 + channel] + source[(y1 * sourceWidth + x1) * 4 + channel];
+					destination[(y * width + x) * 4 + channel] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+} // namespace
+
+const char* CookedTexture::FILE_EXTENSION = ".texcache";
+
+std::string CookedTexture::getCachePath(const std::string& sourcePath)
+{
+	return sourcePath + FILE_EXTENSION;
+}
+
+size_t CookedTexture::getLevelSize(Format format, uint32_t width, uint32_t height)
+{
+	switch (format)
+	{
+	case Format::RGBA8: return size_t(width) * height * 4;
+	case Format::BC1: return size_t((width + 3) / 4) * ((height + 3) / 4) * 8;
+	case Format::BC3: return size_t((width + 3) / 4) * ((height + 3) / 4) * 16;
+	}
+	return 0;
+}
+
+bool CookedTexture::loadOrCook(const std::string& sourcePath, bool flipVertically, bool forceCook)
+{
+	MappedFile source;
+	if (!source.open(sourcePath))
+	{
+		std::cout << "Failure to open texture source " << sourcePath << std::endl;
+		return false;
+	}
+
+	const auto sourceHash = fnv1a64(source.getData(), source.getSize());
+	const auto cachePath = getCachePath(sourcePath);
+	if (!forceCook && load(cachePath, sourceHash, flipVertically)) {
+		return true;
+	}
+
+	if (!cook(source.getData(), source.getSize(), sourceHash, flipVertically)) {
+		return false;
+	}
+
+	// Texture is usable even if cache cannot be written, next run just cooks it again
+	if (!save(cachePath)) {
+		std::cout << "Failure to write texture cache " << cachePath << std::endl;
+	}
+	return true;
+}
+
+bool CookedTexture::load(const std::string& cachePath, uint64_t sourceHash, bool flipVertically)
+{
+	_cookedBytes.clear();
+	if (!_file.open(cachePath)) {
+		return false;
+	}
+
+	if (!parse(_file.getData(), _file.getSize(), sourceHash, flipVertically))
+	{
+		_file.close();
+		return false;
+	}
+	return true;
+}
+
+bool CookedTexture::cook(const unsigned char* sourceBytes, size_t numSourceBytes, uint64_t sourceHash, bool flipVertically)
+{
+	_file.close();
+	_cookedBytes.clear();
+	_levels.clear();
+
+	// Flip flag is per thread, so textures can be cooked on several threads at once
+	stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+	int width, height, numChannels;
+	auto pixels = stbi_load_from_memory(sourceBytes, int(numSourceBytes), &width, &height, &numChannels, 4);
+	if (pixels == nullptr)
+	{
+		std::cout << "Failure to load texture: " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	// Dimensions of the whole mip chain down to 1x1
+	std::vector<LevelEntry> entries;
+	auto levelWidth = uint32_t(width);
+	auto levelHeight = uint32_t(height);
+	auto offset = alignUp(sizeof(FileHeader) + sizeof(LevelEntry) * MAX_LEVELS);
+	while (true)
+	{
+		const auto numBytes = getLevelSize(Format::RGBA8, levelWidth, levelHeight);
+		entries.push_back({ offset, numBytes, levelWidth, levelHeight });
+		offset = alignUp(offset + numBytes);
+
+		if (levelWidth == 1 && levelHeight == 1) {
+			break;
+		}
+		levelWidth = std::max(1u, levelWidth / 2);
+		levelHeight = std::max(1u, levelHeight / 2);
+	}
+
+	// Level table is always reserved for maximum number of levels, so the data offsets do not depend on it
+	_cookedBytes.resize(offset);
+	auto bytes = _cookedBytes.data();
+
+	FileHeader header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.sourceHash = sourceHash;
+	header.format = uint32_t(Format::RGBA8);
+	header.flags = flipVertically ? FLAG_FLIPPED_VERTICALLY : 0;
+	header.width = uint32_t(width);
+	header.height = uint32_t(height);
+	header.numLevels = uint32_t(entries.size());
+	header.reserved = 0;
+	memcpy(bytes, &header, sizeof(header));
+	memcpy(bytes + sizeof(header), entries.data(), sizeof(LevelEntry) * entries.size());
+
+	memcpy(bytes + entries[0].offset, pixels, entries[0].numBytes);
+	stbi_image_free(pixels);
+	for (size_t i = 1; i < entries.size(); i++)
+	{
+		const auto& previous = entries[i - 1];
+		downsample(bytes + previous.offset, previous.width, previous.height,
+			bytes + entries[i].offset, entries[i].width, entries[i].height);
+	}
+
+	return parse(bytes, _cookedBytes.size(), sourceHash, flipVertically);
+}
+
+bool CookedTexture::save(const std::string& cachePath) const
+{
+	if (_cookedBytes.empty()) {
+		return false;
+	}
+
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(_cookedBytes.data()), std::streamsize(_cookedBytes.size()));
+	return bool(file);
+}
+
+CookedTexture::Format CookedTexture::getFormat() const
+{
+	return _format;
+}
+
+const std::vector<CookedTexture::Level>& CookedTexture::getLevels() const
+{
+	return _levels;
+}
+
+void CookedTexture::upload(PixelUploadRing& uploadRing) const
+{
+	for (size_t i = 0; i < _levels.size(); i++)
+	{
+		const auto& level = _levels[i];
+		switch (_format)
+		{
+		case Format::RGBA8:
+			uploadRing.texImage2D(GL_TEXTURE_2D, GLint(i), GL_RGBA8, level.width, level.height,
+				GL_RGBA, GL_UNSIGNED_BYTE, level.data, level.numBytes);
+			break;
+		case Format::BC1:
+			uploadRing.compressedTexImage2D(GL_TEXTURE_2D, GLint(i), GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+				level.width, level.height, level.data, level.numBytes);
+			break;
+		case Format::BC3:
+			uploadRing.compressedTexImage2D(GL_TEXTURE_2D, GLint(i), GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+				level.width, level.height, level.data, level.numBytes);
+			break;
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(_levels.size()) - 1);
+
+	// Mip chain is sampled only once it is complete, single level textures stay filtered linearly
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+}
+
+bool CookedTexture::parse(const unsigned char* bytes, size_t numBytes, uint64_t sourceHash, bool flipVertically)
+{
+	_levels.clear();
+	if (numBytes < sizeof(FileHeader)) {
+		return false;
+	}
+
+	FileHeader header;
+	memcpy(&header, bytes, sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+		return false;
+	}
+
+	// Stale cache of changed source image or cooked with other orientation
+	const auto flags = flipVertically ? FLAG_FLIPPED_VERTICALLY : 0;
+	if (header.sourceHash != sourceHash || header.flags != flags) {
+		return false;
+	}
+
+	if (header.format > uint32_t(Format::BC3) || header.numLevels == 0 || header.numLevels > MAX_LEVELS
+		|| sizeof(FileHeader) + sizeof(LevelEntry) * header.numLevels > numBytes) {
+		return false;
+	}
+
+	const auto format = Format(header.format);
+	for (uint32_t i = 0; i < header.numLevels; i++)
+	{
+		LevelEntry entry;
+		memcpy(&entry, bytes + sizeof(FileHeader) + sizeof(LevelEntry) * i, sizeof(entry));
+
+		const auto expectedWidth = std::max(1u, header.width >> i);
+		const auto expectedHeight = std::max(1u, header.height >> i);
+		if (entry.width != expectedWidth || entry.height != expectedHeight
+			|| entry.numBytes != getLevelSize(format, entry.width, entry.height)
+			|| entry.offset > numBytes || entry.numBytes > numBytes - entry.offset)
+		{
+			_levels.clear();
+			return false;
+		}
+
+		_levels.push_back({ GLsizei(entry.width), GLsizei(entry.height), bytes + entry.offset, size_t(entry.numBytes) });
+	}
+
+	_format = format;
+	return true;
+}
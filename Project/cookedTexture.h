@@ -0,0 +1,85 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Project
+#include "mappedFile.h"
+#include "pixelUploadRing.h"
+
+/**
+* Texture with pre-generated mip chain, stored in a binary cache file next to its source image
+* (source path + ".texcache"). The cache is memory mapped and its levels are uploaded as they are,
+* so neither image decoding nor mipmap generation happens at runtime. The cache stores hash of the
+* source image, a cache with different hash is stale and gets cooked again from the source.
+*
+* Cache layout (little endian): header, table of levels, level data at 16 byte aligned offsets.
+*/
+class CookedTexture
+{
+public:
+	/** \brief Pixel format of all levels. Cooker writes RGBA8, BC1 and BC3 caches can be loaded as well. */
+	enum class Format : uint32_t
+	{
+		RGBA8 = 0,
+		BC1 = 1,
+		BC3 = 2
+	};
+
+	/** \brief One mip level, pointing into the cache memory. */
+	struct Level
+	{
+		GLsizei width;
+		GLsizei height;
+		const unsigned char* data;
+		size_t numBytes;
+	};
+
+	static const char* FILE_EXTENSION; //!< Extension appended to source path to get cache path
+
+	/** \brief  Gets path of cache file of given source image. */
+	static std::string getCachePath(const std::string& sourcePath);
+
+	/** \brief  Gets exact size of level with given dimensions in given format. */
+	static size_t getLevelSize(Format format, uint32_t width, uint32_t height);
+
+	/** \brief  Loads cache of source image. If it is missing or stale (or cooking is forced), cooks it from the source and saves it.
+	*   \return True, if texture is ready for upload.
+	*/
+	bool loadOrCook(const std::string& sourcePath, bool flipVertically = true, bool forceCook = false);
+
+	/** \brief  Maps cache file and validates it against hash of its source.
+	*   \return True, if cache is valid and up to date.
+	*/
+	bool load(const std::string& cachePath, uint64_t sourceHash, bool flipVertically);
+
+	/** \brief  Decodes source image from memory and generates its RGBA8 mip chain. */
+	bool cook(const unsigned char* sourceBytes, size_t numSourceBytes, uint64_t sourceHash, bool flipVertically);
+
+	/** \brief  Writes cooked texture to a cache file. */
+	bool save(const std::string& cachePath) const;
+
+	/** \brief  Gets pixel format of the levels. */
+	Format getFormat() const;
+
+	/** \brief  Gets all mip levels, biggest first. */
+	const std::vector<Level>& getLevels() const;
+
+	/** \brief  Uploads all levels to currently bound GL_TEXTURE_2D through given upload ring and enables trilinear filtering, if it has mip levels. */
+	void upload(PixelUploadRing& uploadRing) const;
+
+private:
+	MappedFile _file; // Mapped cache file, when loaded from disk
+	std::vector<unsigned char> _cookedBytes; // Cache contents, when cooked in memory
+	Format _format = Format::RGBA8; // Pixel format of the levels
+	std::vector<Level> _levels; // Mip levels pointing into the mapped file or cooked bytes
+
+	bool parse(const unsigned char* bytes, size_t numBytes, uint64_t sourceHash, bool flipVertically);
+};
+
+#endif
@@ -7,13 +7,14 @@
 
 // Project
 #include "cylinder.h"
+#include "glStateCache.h"
 
 
 
 namespace static_meshes_3D {
 
-	Cylinder::Cylinder(float radius, int numSlices, float height, bool withPositions, bool withTextureCoordinates, bool withNormals)
-		: StaticMesh3D(withPositions, withTextureCoordinates, withNormals)
+	Cylinder::Cylinder(float radius, int numSlices, float height, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+		: StaticMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout)
 		, _radius(radius)
 		, _numSlices(numSlices)
 		, _height(height)
@@ -49,7 +50,7 @@ namespace static_meshes_3D {
 
 		// Generate VAO and VBO for vertex attributes
 		glGenVertexArrays(1, &_vao);
-		glBindVertexArray(_vao);
+		GLStateCache::getInstance().bindVertexArray(_vao);
 		_vbo.createVBO(getVertexByteSize() * _numVerticesTotal);
 
 		// Pre-calculate sines / cosines for given number of slices
@@ -65,8 +66,14 @@ namespace static_meshes_3D {
 			currentSliceAngle += sliceAngleStep;
 		}
 
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> textureCoordinates;
+		std::vector<glm::vec3> normals;
+
 		if (hasPositions())
 		{
+			positions.reserve(_numVerticesTotal);
+
 			// Pre-calculate X and Z coordinates
 			std::vector<float> x;
 			std::vector<float> z;
@@ -79,33 +86,27 @@ namespace static_meshes_3D {
 			// Add cylinder side vertices
 			for (auto i = 0; i <= _numSlices; i++)
 			{
-				const auto topPosition = glm::vec3(x[i], _height / 2.0f, z[i]);
-				const auto bottomPosition = glm::vec3(x[i], -_height / 2.0f, z[i]);
-				_vbo.addRawData(&topPosition, sizeof(glm::vec3));
-				_vbo.addRawData(&bottomPosition, sizeof(glm::vec3));
+				positions.push_back(glm::vec3(x[i], _height / 2.0f, z[i]));
+				positions.push_back(glm::vec3(x[i], -_height / 2.0f, z[i]));
 			}
 
 			// Add top cylinder cover
-			glm::vec3 topCenterPosition(0.0f, _height / 2.0f, 0.0f);
-			_vbo.addRawData(&topCenterPosition, sizeof(glm::vec3));
-			for (auto i = 0; i <= _numSlices; i++)
-			{
-				const auto topPosition = glm::vec3(x[i], _height / 2.0f, z[i]);
-				_vbo.addRawData(&topPosition, sizeof(glm::vec3));
+			positions.push_back(glm::vec3(0.0f, _height / 2.0f, 0.0f));
+			for (auto i = 0; i <= _numSlices; i++) {
+				positions.push_back(glm::vec3(x[i], _height / 2.0f, z[i]));
 			}
 
 			// Add bottom cylinder cover
-			glm::vec3 bottomCenterPosition(0.0f, -_height / 2.0f, 0.0f);
-			_vbo.addRawData(&bottomCenterPosition, sizeof(glm::vec3));
-			for (auto i = 0; i <= _numSlices; i++)
-			{
-				const auto bottomPosition = glm::vec3(x[i], -_height / 2.0f, -z[i]);
-				_vbo.addRawData(&bottomPosition, sizeof(glm::vec3));
+			positions.push_back(glm::vec3(0.0f, -_height / 2.0f, 0.0f));
+			for (auto i = 0; i <= _numSlices; i++) {
+				positions.push_back(glm::vec3(x[i], -_height / 2.0f, -z[i]));
 			}
 		}
 
 		if (hasTextureCoordinates())
 		{
+			textureCoordinates.reserve(_numVerticesTotal);
+
 			// Pre-calculate step size in texture coordinate U
 			// I have decided to map the texture twice around cylinder, looks fine
 			const auto sliceTextureStepU = 2.0f / float(_numSlices);
@@ -113,8 +114,8 @@ namespace static_meshes_3D {
 			auto currentSliceTexCoordU = 0.0f;
 			for (auto i = 0; i <= _numSlices; i++)
 			{
-				_vbo.addData(glm::vec2(currentSliceTexCoordU, 1.0f));
-				_vbo.addData(glm::vec2(currentSliceTexCoordU, 0.0f));
+				textureCoordinates.push_back(glm::vec2(currentSliceTexCoordU, 1.0f));
+				textureCoordinates.push_back(glm::vec2(currentSliceTexCoordU, 0.0f));
 
 				// Update texture coordinate of current slice 
 				currentSliceTexCoordU += sliceTextureStepU;
@@ -122,31 +123,43 @@ namespace static_meshes_3D {
 
 			// Generate circle texture coordinates for cylinder top cover
 			glm::vec2 topBottomCenterTexCoord(0.5f, 0.5f);
-			_vbo.addData(topBottomCenterTexCoord);
+			textureCoordinates.push_back(topBottomCenterTexCoord);
 			for (auto i = 0; i <= _numSlices; i++) {
-				_vbo.addData(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y + cosines[i] * 0.5f));
+				textureCoordinates.push_back(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y + cosines[i] * 0.5f));
 			}
 
 			// Generate circle texture coordinates for cylinder bottom cover
-			_vbo.addData(topBottomCenterTexCoord);
+			textureCoordinates.push_back(topBottomCenterTexCoord);
 			for (auto i = 0; i <= _numSlices; i++) {
-				_vbo.addData(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y - cosines[i] * 0.5f));
+				textureCoordinates.push_back(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y - cosines[i] * 0.5f));
 			}
 		}
 
 		if (hasNormals())
 		{
-			for (auto i = 0; i <= _numSlices; i++) {
-				_vbo.addData(glm::vec3(cosines[i], 0.0f, sines[i]), 2);
+			normals.reserve(_numVerticesTotal);
+			for (auto i = 0; i <= _numSlices; i++)
+			{
+				normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
+				normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
 			}
 
 			// Add normal for every vertex of cylinder top cover
-			_vbo.addData(glm::vec3(0.0f, 1.0f, 0.0f), _numVerticesTopBottom);
+			normals.insert(normals.end(), _numVerticesTopBottom, glm::vec3(0.0f, 1.0f, 0.0f));
 
 			// Add normal for every vertex of cylinder bottom cover
-			_vbo.addData(glm::vec3(0.0f, -1.0f, 0.0f), _numVerticesTopBottom);
+			normals.insert(normals.end(), _numVerticesTopBottom, glm::vec3(0.0f, -1.0f, 0.0f));
 		}
 
+		// Store gathered attributes in the VBO, either planar or interleaved
+		addVertexData(positions, textureCoordinates, normals);
+
+		// Bounding volumes follow directly from the dimensions, even if the mesh has no positions
+		_bounds.min = glm::vec3(-_radius, -_height / 2.0f, -_radius);
+		_bounds.max = glm::vec3(_radius, _height / 2.0f, _radius);
+		_boundingSphere.center = glm::vec3(0.0f);
+		_boundingSphere.radius = sqrt(_radius * _radius + _height * _height / 4.0f);
+
 		// Finally upload data to the GPU
 		_vbo.bindVBO();
 		_vbo.uploadDataToGPU(GL_STATIC_DRAW);
@@ -161,7 +174,7 @@ namespace static_meshes_3D {
 			return;
 		}
 
-		glBindVertexArray(_vao);
+		GLStateCache::getInstance().bindVertexArray(_vao);
 
 		// Render cylinder side first
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVerticesSide);
@@ -173,6 +186,20 @@ namespace static_meshes_3D {
 		glDrawArrays(GL_TRIANGLE_FAN, _numVerticesSide + _numVerticesTopBottom, _numVerticesTopBottom);
 	}
 
+	void Cylinder::renderInstanced(int numInstances) const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+
+		// Same three parts as in render, just for all instances at once
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, _numVerticesSide, numInstances);
+		glDrawArraysInstanced(GL_TRIANGLE_FAN, _numVerticesSide, _numVerticesTopBottom, numInstances);
+		glDrawArraysInstanced(GL_TRIANGLE_FAN, _numVerticesSide + _numVerticesTopBottom, _numVerticesTopBottom, numInstances);
+	}
+
 	void Cylinder::renderPoints() const
 	{
 		if (!_isInitialized) {
@@ -180,7 +207,7 @@ namespace static_meshes_3D {
 		}
 
 		// Just render all points as they are stored in the VBO
-		glBindVertexArray(_vao);
+		GLStateCache::getInstance().bindVertexArray(_vao);
 		glDrawArrays(GL_POINTS, 0, _numVerticesTotal);
 	}
 
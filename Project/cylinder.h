@@ -11,10 +11,12 @@ namespace static_meshes_3D {
 	{
 	public:
 		Cylinder(float radius, int numSlices, float height,
-			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true);
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar);
 
 		void render() const override;
 		void renderPoints() const override;
+		void renderInstanced(int numInstances) const override;
 
 		/**
 		 * Gets cylinder radius.
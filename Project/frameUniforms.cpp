@@ -0,0 +1,31 @@
+// Project
+#include "frameUniforms.h"
+#include "glStateCache.h"
+
+const GLuint FrameUniforms::BINDING_POINT = 0;
+const char* FrameUniforms::BLOCK_NAME = "FrameUniforms";
+
+void FrameUniforms::createUBO()
+{
+	_ubo.createVBO(sizeof(BlockData));
+	_ubo.bindVBO(GL_UNIFORM_BUFFER);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+	GLStateCache::getInstance().bindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, _ubo.getBufferID());
+}
+
+void FrameUniforms::update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPosition, float time)
+{
+	BlockData data;
+	data.projection = projection;
+	data.view = view;
+	data.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+	data.time = time;
+
+	_ubo.bindVBO(GL_UNIFORM_BUFFER);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+}
+
+void FrameUniforms::deleteUBO()
+{
+	_ubo.deleteVBO();
+}
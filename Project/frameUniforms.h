@@ -0,0 +1,48 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "common/vertexBufferObject.h"
+
+/**
+  Uniform buffer object with per-frame camera data, shared by all shader programs.
+  It is bound to a fixed binding point and updated once per frame, shaders read it
+  through the "FrameUniforms" uniform block.
+*/
+class FrameUniforms
+{
+public:
+	static const GLuint BINDING_POINT; //!< Uniform buffer binding point of the block (0)
+	static const char* BLOCK_NAME; //!< Name of the uniform block in shaders ("FrameUniforms")
+
+	/** \brief Creates the uniform buffer and binds it to the binding point. */
+	void createUBO();
+
+	/** \brief Uploads camera data of the current frame.
+	*   \param projection     Projection matrix
+	*   \param view           View matrix
+	*   \param cameraPosition Camera position in world space
+	*   \param time           Time since start, in seconds
+	*/
+	void update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPosition, float time);
+
+	//* \brief Deletes the uniform buffer.
+	void deleteUBO();
+
+private:
+	// Mirrors std140 layout of the uniform block
+	struct BlockData
+	{
+		glm::mat4 projection;
+		glm::mat4 view;
+		glm::vec4 cameraPosition;
+		float time;
+		float padding[3];
+	};
+
+	VertexBufferObject _ubo; //! Buffer holding block data on the GPU
+};
+#endif
@@ -0,0 +1,185 @@
+// STL
+#include <cmath>
+
+// Project
+#include "frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_SSE2
+#include <emmintrin.h>
+#endif
+
+void Frustum::setFromMatrix(const glm::mat4& viewProjection)
+{
+	// Rows of the matrix, GLM stores columns
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	_planes[0] = rows[3] + rows[0]; // Left
+	_planes[1] = rows[3] - rows[0]; // Right
+	_planes[2] = rows[3] + rows[1]; // Bottom
+	_planes[3] = rows[3] - rows[1]; // Top
+	_planes[4] = rows[3] + rows[2]; // Near
+	_planes[5] = rows[3] - rows[2]; // Far
+
+	for (int i = 0; i < 8; i++)
+	{
+		auto& plane = _planes[i < NUM_PLANES ? i : 0];
+		if (i < NUM_PLANES) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+
+		_planesX[i] = plane.x;
+		_planesY[i] = plane.y;
+		_planesZ[i] = plane.z;
+		_planesW[i] = plane.w;
+	}
+}
+
+const glm::vec4& Frustum::getPlane(int plane) const
+{
+	return _planes[plane];
+}
+
+Frustum::Containment Frustum::classifyBox(const BoundingBox& box) const
+{
+	if (box.isEmpty()) {
+		return Containment::Outside;
+	}
+
+	const auto center = box.getCenter();
+	const auto extents = box.getExtents();
+	auto isIntersecting = false;
+
+#ifdef FRUSTUM_SSE2
+	const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const auto cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+	const auto ex = _mm_set1_ps(extents.x), ey = _mm_set1_ps(extents.y), ez = _mm_set1_ps(extents.z);
+
+	for (int group = 0; group < 8; group += 4)
+	{
+		const auto nx = _mm_load_ps(_planesX + group), ny = _mm_load_ps(_planesY + group), nz = _mm_load_ps(_planesZ + group);
+		const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+			_mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(_planesW + group)));
+		const auto projectedRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex),
+			_mm_mul_ps(_mm_and_ps(ny, absMask), ey)), _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, projectedRadius), _mm_setzero_ps())) != 0) {
+			return Containment::Outside;
+		}
+
+		// Box crosses a plane, when the plane is nearer to the center than the projected radius
+		isIntersecting = isIntersecting || _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, projectedRadius), _mm_setzero_ps())) != 0;
+	}
+#else
+	for (int plane = 0; plane < NUM_PLANES; plane++)
+	{
+		const auto distance = _planesX[plane] * center.x + _planesY[plane] * center.y + _planesZ[plane] * center.z + _planesW[plane];
+		const auto projectedRadius = std::fabs(_planesX[plane]) * extents.x + std::fabs(_planesY[plane]) * extents.y
+			+ std::fabs(_planesZ[plane]) * extents.z;
+		if (distance + projectedRadius < 0.0f) {
+			return Containment::Outside;
+		}
+		isIntersecting = isIntersecting || distance - projectedRadius < 0.0f;
+	}
+#endif
+
+	return isIntersecting ? Containment::Intersecting : Containment::Inside;
+}
+
+void Frustum::countObjects(int numVisible, int numCulled)
+{
+	_counters.visible += numVisible;
+	_counters.culled += numCulled;
+}
+
+int Frustum::cullBoxes(const float* centersX, const float* centersY, const float* centersZ,
+	const float* extentsX, const float* extentsY, const float* extentsZ, int numBoxes, uint8_t* isVisible) const
+{
+	int numVisible = 0;
+	int i = 0;
+
+#ifdef FRUSTUM_SSE2
+	// Four boxes in the lanes, planes one after another
+	for (; i + 4 <= numBoxes; i += 4)
+	{
+		const auto cx = _mm_loadu_ps(centersX + i), cy = _mm_loadu_ps(centersY + i), cz = _mm_loadu_ps(centersZ + i);
+		const auto ex = _mm_loadu_ps(extentsX + i), ey = _mm_loadu_ps(extentsY + i), ez = _mm_loadu_ps(extentsZ + i);
+
+		auto outside = _mm_setzero_ps();
+		for (int plane = 0; plane < NUM_PLANES; plane++)
+		{
+			const auto nx = _mm_set1_ps(_planesX[plane]), ny = _mm_set1_ps(_planesY[plane]), nz = _mm_set1_ps(_planesZ[plane]);
+
+			// Signed distance of the center and projected radius of the box onto the plane normal
+			const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+				_mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(_planesW[plane])));
+			const auto radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(_planesX[plane])), ex),
+				_mm_mul_ps(_mm_set1_ps(std::fabs(_planesY[plane])), ey)), _mm_mul_ps(_mm_set1_ps(std::fabs(_planesZ[plane])), ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		const auto outsideMask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			isVisible[i + lane] = (outsideMask & (1 << lane)) ? 0 : 1;
+			numVisible += isVisible[i + lane];
+		}
+	}
+#endif
+
+	for (; i < numBoxes; i++)
+	{
+		const auto center = glm::vec3(centersX[i], centersY[i], centersZ[i]);
+		const auto extents = glm::vec3(extentsX[i], extentsY[i], extentsZ[i]);
+		isVisible[i] = isInside(center, extents) ? 1 : 0;
+		numVisible += isVisible[i];
+	}
+
+	return numVisible;
+}
+
+const Frustum::Counters& Frustum::getCounters() const
+{
+	return _counters;
+}
+
+void Frustum::resetCounters()
+{
+	_counters = Counters();
+}
+
+bool Frustum::isInside(const glm::vec3& center, const glm::vec3& extents) const
+{
+#ifdef FRUSTUM_SSE2
+	// Four planes in the lanes, two groups cover all six planes
+	const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const auto cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+	const auto ex = _mm_set1_ps(extents.x), ey = _mm_set1_ps(extents.y), ez = _mm_set1_ps(extents.z);
+
+	for (int group = 0; group < 8; group += 4)
+	{
+		const auto nx = _mm_load_ps(_planesX + group), ny = _mm_load_ps(_planesY + group), nz = _mm_load_ps(_planesZ + group);
+		const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+			_mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(_planesW + group)));
+		const auto projectedRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex),
+			_mm_mul_ps(_mm_and_ps(ny, absMask), ey)), _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, projectedRadius), _mm_setzero_ps())) != 0) {
+			return false;
+		}
+	}
+	return true;
+#else
+	for (int plane = 0; plane < NUM_PLANES; plane++)
+	{
+		const auto distance = _planesX[plane] * center.x + _planesY[plane] * center.y + _planesZ[plane] * center.z + _planesW[plane];
+		const auto projectedRadius = std::fabs(_planesX[plane]) * extents.x + std::fabs(_planesY[plane]) * extents.y
+			+ std::fabs(_planesZ[plane]) * extents.z;
+		if (distance + projectedRadius < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+#endif
+}
@@ -0,0 +1,80 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+// STL
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "boundingVolumes.h"
+
+/**
+  View frustum as six planes extracted from a projection * view matrix (Gribb-Hartmann).
+  Planes point inside, an object is culled when it lies completely behind any of them.
+  Single boxes are tested against four planes at a time, batches of boxes four boxes
+  at a time (SSE2, with a scalar fallback). Tests do not count objects, callers report
+  them with countObjects().
+*/
+class Frustum
+{
+public:
+	static const int NUM_PLANES = 6; //!< Left, right, bottom, top, near and far plane
+
+	/** \brief Counters of tested objects since last reset. */
+	struct Counters
+	{
+		uint64_t visible = 0; //!< Objects, that intersect the frustum
+		uint64_t culled = 0; //!< Objects, that lie completely outside
+	};
+
+	/** \brief Position of a volume relative to the frustum. */
+	enum class Containment
+	{
+		Outside, //!< Completely outside
+		Intersecting, //!< Partially inside
+		Inside //!< Completely inside
+	};
+
+	/** \brief Extracts normalized planes from combined projection * view matrix, so that tests work in world space. */
+	void setFromMatrix(const glm::mat4& viewProjection);
+
+	/** \brief Gets plane as (normal, distance), points p with dot(normal, p) + distance >= 0 are inside. */
+	const glm::vec4& getPlane(int plane) const;
+
+	/** \brief Classifies box, e.g. a node of a hierarchy. Empty boxes are outside. */
+	Containment classifyBox(const BoundingBox& box) const;
+
+	/** \brief Adds objects tested elsewhere (e.g. by a hierarchy query) to the counters. */
+	void countObjects(int numVisible, int numCulled);
+
+	/** \brief  Tests batch of boxes given by centers and extents in structure-of-arrays form, e.g. objects of a hierarchy leaf.
+	*   Boxes with negative extents are never visible.
+	*   \param  isVisible Receives 1 for every visible box and 0 for every culled box
+	*   \return Number of visible boxes.
+	*/
+	int cullBoxes(const float* centersX, const float* centersY, const float* centersZ,
+		const float* extentsX, const float* extentsY, const float* extentsZ, int numBoxes, uint8_t* isVisible) const;
+
+	/** \brief Gets counters of visible and culled objects since last reset. */
+	const Counters& getCounters() const;
+
+	/** \brief Resets counters of visible and culled objects. */
+	void resetCounters();
+
+private:
+	glm::vec4 _planes[NUM_PLANES];
+
+	// Plane components in structure-of-arrays form, padded to two groups of four by repeating the first plane
+	alignas(16) float _planesX[8];
+	alignas(16) float _planesY[8];
+	alignas(16) float _planesZ[8];
+	alignas(16) float _planesW[8];
+
+	Counters _counters;
+
+	/** \brief Tests box given by center and extents against all planes. */
+	bool isInside(const glm::vec3& center, const glm::vec3& extents) const;
+};
+#endif
@@ -0,0 +1,100 @@
+// STL
+#include <iostream>
+
+// Project
+#include "common/staticMesh3D.h"
+#include "geometryArena.h"
+#include "glStateCache.h"
+
+namespace static_meshes_3D {
+
+	const int GeometryArena::FLOATS_PER_VERTEX = 5;
+
+	GeometryArena::GeometryArena(int capacityVertices)
+		: _capacityVertices(capacityVertices)
+	{
+		glGenVertexArrays(1, &_vao);
+		_vbo.createVBO(sizeof(float) * FLOATS_PER_VERTEX * capacityVertices);
+	}
+
+	GeometryArena::~GeometryArena()
+	{
+		deleteArena();
+	}
+
+	GeometryRange GeometryArena::addGeometry(const float* vertexData, int numVertices)
+	{
+		if (_isUploaded || _numVertices + numVertices > _capacityVertices)
+		{
+			std::cerr << "Cannot add " << numVertices << " vertices to geometry arena, it is full or already uploaded!" << std::endl;
+			return GeometryRange();
+		}
+
+		_vbo.addRawData(vertexData, sizeof(float) * FLOATS_PER_VERTEX * numVertices);
+
+		GeometryRange range;
+		range.vao = _vao;
+		range.baseVertex = _numVertices;
+		range.count = numVertices;
+		range.bounds = BoundingBox::fromPoints(vertexData, numVertices, sizeof(float) * FLOATS_PER_VERTEX);
+
+		_numVertices += numVertices;
+		return range;
+	}
+
+	void GeometryArena::uploadToGPU()
+	{
+		if (_isUploaded) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		_vbo.bindVBO();
+		_vbo.uploadDataToGPU(GL_STATIC_DRAW);
+
+		// Position attribute
+		const auto stride = sizeof(float) * FLOATS_PER_VERTEX;
+		glVertexAttribPointer(StaticMesh3D::POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+		glEnableVertexAttribArray(StaticMesh3D::POSITION_ATTRIBUTE_INDEX);
+
+		// Texture coord attribute
+		glVertexAttribPointer(StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX);
+
+		_isUploaded = true;
+	}
+
+	void GeometryArena::render(const GeometryRange& range) const
+	{
+		if (!_isUploaded || range.count == 0) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(range.vao);
+		glDrawArrays(GL_TRIANGLES, range.baseVertex, range.count);
+	}
+
+	GLuint GeometryArena::getVAO() const
+	{
+		return _vao;
+	}
+
+	int GeometryArena::getNumVertices() const
+	{
+		return _numVertices;
+	}
+
+	void GeometryArena::deleteArena()
+	{
+		if (_vao == 0) {
+			return;
+		}
+
+		GLStateCache::getInstance().onVertexArrayDeleted(_vao);
+		glDeleteVertexArrays(1, &_vao);
+		_vbo.deleteVBO();
+		_vao = 0;
+		_isUploaded = false;
+	}
+
+} // namespace static_meshes_3D
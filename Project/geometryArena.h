@@ -0,0 +1,65 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+// Project
+#include "boundingVolumes.h"
+#include "common/vertexBufferObject.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Handle to a range of vertices sub-allocated from a geometry arena.
+	*/
+	struct GeometryRange
+	{
+		GLuint vao = 0; //!< VAO of the arena, that owns the vertices
+		GLint baseVertex = 0; //!< Index of the first vertex of the range within the arena
+		GLsizei count = 0; //!< Number of vertices in the range
+		BoundingBox bounds; //!< Bounding box of the vertex positions
+	};
+
+	/**
+	* One large GPU buffer holding all static geometry of the scene. Every piece of geometry is
+	* sub-allocated as a range of vertices, so all of it is rendered from a single VAO and VBO.
+	* Vertices consist of position and texture coordinate (5 floats), same as the scene vertex data.
+	*/
+	class GeometryArena
+	{
+	public:
+		static const int FLOATS_PER_VERTEX; //!< Number of floats of one vertex (3 for position + 2 for texture coordinate)
+
+		GeometryArena(int capacityVertices);
+		~GeometryArena();
+
+		/** \brief  Copies vertices into the arena. Must be called before uploading to the GPU.
+		*   \param  vertexData  Vertex data, FLOATS_PER_VERTEX floats per vertex
+		*   \param  numVertices Number of vertices to add
+		*   \return Range handle of the added vertices, or empty range if arena is full.
+		*/
+		GeometryRange addGeometry(const float* vertexData, int numVertices);
+
+		/** \brief  Uploads all added geometry to the GPU and sets up vertex attributes of the arena VAO. */
+		void uploadToGPU();
+
+		/** \brief  Renders range of vertices as triangles. */
+		void render(const GeometryRange& range) const;
+
+		/** \brief  Gets VAO shared by all geometry in the arena. */
+		GLuint getVAO() const;
+
+		/** \brief  Gets number of vertices allocated so far. */
+		int getNumVertices() const;
+
+		/** \brief  Deletes arena data from the GPU. */
+		void deleteArena();
+
+	private:
+		GLuint _vao = 0; // VAO shared by all ranges
+		VertexBufferObject _vbo; // Single VBO holding all vertices
+		int _capacityVertices = 0; // Maximal number of vertices
+		int _numVertices = 0; // Number of vertices allocated so far
+		bool _isUploaded = false; // Flag telling, if data has been uploaded to GPU already
+	};
+
+} // namespace static_meshes_3D
+#endif
@@ -0,0 +1,218 @@
+// Project
+#include "glStateCache.h"
+
+GLStateCache& GLStateCache::getInstance()
+{
+	static GLStateCache instance;
+	return instance;
+}
+
+GLStateCache::GLStateCache()
+{
+	invalidate();
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (needsUpdate(_program, program)) {
+		glUseProgram(program);
+	}
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+	if (needsUpdate(_vao, vao))
+	{
+		glBindVertexArray(vao);
+
+		// Element array buffer binding is part of the VAO state
+		_buffers[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+	}
+}
+
+void GLStateCache::activeTexture(GLenum textureUnit)
+{
+	const auto unit = int(textureUnit - GL_TEXTURE0);
+	if (unit == _activeTextureUnit)
+	{
+		_counters.skipped++;
+		return;
+	}
+
+	glActiveTexture(textureUnit);
+	_activeTextureUnit = unit;
+	_counters.issued++;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	const auto slot = getTextureTargetSlot(target);
+	if (slot < 0 || _activeTextureUnit < 0 || _activeTextureUnit >= MAX_TEXTURE_UNITS)
+	{
+		glBindTexture(target, texture);
+		_counters.issued++;
+		return;
+	}
+
+	if (needsUpdate(_textures[_activeTextureUnit][slot], texture)) {
+		glBindTexture(target, texture);
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	const auto slot = getBufferTargetSlot(target);
+	if (slot < 0)
+	{
+		glBindBuffer(target, buffer);
+		_counters.issued++;
+		return;
+	}
+
+	if (needsUpdate(_buffers[slot], buffer)) {
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	GLuint* indexedBindings = nullptr;
+	if (target == GL_UNIFORM_BUFFER) {
+		indexedBindings = _uniformBufferBindings;
+	}
+	else if (target == GL_SHADER_STORAGE_BUFFER) {
+		indexedBindings = _storageBufferBindings;
+	}
+
+	if (indexedBindings != nullptr && index < GLuint(MAX_BUFFER_BINDINGS))
+	{
+		if (!needsUpdate(indexedBindings[index], buffer)) {
+			return;
+		}
+	}
+	else {
+		_counters.issued++;
+	}
+
+	glBindBufferBase(target, index, buffer);
+	const auto slot = getBufferTargetSlot(target);
+	if (slot >= 0) {
+		_buffers[slot] = buffer;
+	}
+}
+
+void GLStateCache::onProgramDeleted(GLuint program)
+{
+	if (_program == program) {
+		_program = UNKNOWN;
+	}
+}
+
+void GLStateCache::onVertexArrayDeleted(GLuint vao)
+{
+	if (_vao == vao) {
+		_vao = 0;
+		_buffers[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+	}
+}
+
+void GLStateCache::onTextureDeleted(GLuint texture)
+{
+	for (auto& unitTextures : _textures)
+	{
+		for (auto& boundTexture : unitTextures)
+		{
+			if (boundTexture == texture) {
+				boundTexture = 0;
+			}
+		}
+	}
+}
+
+void GLStateCache::onBufferDeleted(GLuint buffer)
+{
+	for (auto& boundBuffer : _buffers)
+	{
+		if (boundBuffer == buffer) {
+			boundBuffer = 0;
+		}
+	}
+	for (int i = 0; i < MAX_BUFFER_BINDINGS; i++)
+	{
+		if (_uniformBufferBindings[i] == buffer) {
+			_uniformBufferBindings[i] = 0;
+		}
+		if (_storageBufferBindings[i] == buffer) {
+			_storageBufferBindings[i] = 0;
+		}
+	}
+}
+
+void GLStateCache::invalidate()
+{
+	_program = UNKNOWN;
+	_vao = UNKNOWN;
+	_activeTextureUnit = -1;
+	for (auto& unitTextures : _textures)
+	{
+		for (auto& boundTexture : unitTextures) {
+			boundTexture = UNKNOWN;
+		}
+	}
+	for (auto& boundBuffer : _buffers) {
+		boundBuffer = UNKNOWN;
+	}
+	for (int i = 0; i < MAX_BUFFER_BINDINGS; i++)
+	{
+		_uniformBufferBindings[i] = UNKNOWN;
+		_storageBufferBindings[i] = UNKNOWN;
+	}
+}
+
+const GLStateCache::Counters& GLStateCache::getCounters() const
+{
+	return _counters;
+}
+
+void GLStateCache::resetCounters()
+{
+	_counters = Counters();
+}
+
+int GLStateCache::getTextureTargetSlot(GLenum target)
+{
+	switch (target)
+	{
+		case GL_TEXTURE_2D: return TEXTURE_2D;
+		case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+		case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+		default: return -1;
+	}
+}
+
+int GLStateCache::getBufferTargetSlot(GLenum target)
+{
+	switch (target)
+	{
+		case GL_ARRAY_BUFFER: return ARRAY_BUFFER;
+		case GL_ELEMENT_ARRAY_BUFFER: return ELEMENT_ARRAY_BUFFER;
+		case GL_UNIFORM_BUFFER: return UNIFORM_BUFFER;
+		case GL_SHADER_STORAGE_BUFFER: return SHADER_STORAGE_BUFFER;
+		case GL_DRAW_INDIRECT_BUFFER: return DRAW_INDIRECT_BUFFER;
+		case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK_BUFFER;
+		default: return -1;
+	}
+}
+
+bool GLStateCache::needsUpdate(GLuint& shadowed, GLuint value)
+{
+	if (shadowed == value)
+	{
+		_counters.skipped++;
+		return false;
+	}
+
+	shadowed = value;
+	_counters.issued++;
+	return true;
+}
@@ -0,0 +1,79 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+// STL
+#include <cstdint>
+
+#include <glad/glad.h>
+
+/**
+  Shadows the OpenGL binding state of the current context and skips calls,
+  that would not change anything. All binds of programs, VAOs, textures and
+  buffers must go through this class, otherwise the shadowed state gets stale
+  (call invalidate() after binding something directly).
+*/
+class GLStateCache
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 32; //!< Number of texture units, whose bindings are shadowed
+	static const int MAX_BUFFER_BINDINGS = 16; //!< Number of indexed uniform and shader storage buffer binding points, that are shadowed
+
+	/** \brief Counters of state changing calls, that were issued to OpenGL or skipped. */
+	struct Counters
+	{
+		uint64_t issued = 0; //!< Calls, that reached OpenGL
+		uint64_t skipped = 0; //!< Calls, that were skipped as no-ops
+	};
+
+	/** \brief Gets the state cache of the (single) OpenGL context. */
+	static GLStateCache& getInstance();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vao);
+	void activeTexture(GLenum textureUnit);
+	void bindTexture(GLenum target, GLuint texture);
+	void bindBuffer(GLenum target, GLuint buffer);
+
+	/** \brief Binds buffer to indexed binding point, which also binds it to the generic binding point of the target. */
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+	/** \brief Notifications about deleted objects, OpenGL unbinds them implicitly. */
+	void onProgramDeleted(GLuint program);
+	void onVertexArrayDeleted(GLuint vao);
+	void onTextureDeleted(GLuint texture);
+	void onBufferDeleted(GLuint buffer);
+
+	/** \brief Forgets all shadowed state, next binds are always issued. */
+	void invalidate();
+
+	/** \brief Gets counters of issued and skipped calls since last reset. */
+	const Counters& getCounters() const;
+
+	//* \brief Resets counters of issued and skipped calls.
+	void resetCounters();
+
+private:
+	static const GLuint UNKNOWN = 0xFFFFFFFF; // Binding, that is not known and must always be issued
+
+	enum TextureTarget { TEXTURE_2D, TEXTURE_2D_ARRAY, TEXTURE_CUBE_MAP, NUM_TEXTURE_TARGETS };
+	enum BufferTarget { ARRAY_BUFFER, ELEMENT_ARRAY_BUFFER, UNIFORM_BUFFER, SHADER_STORAGE_BUFFER, DRAW_INDIRECT_BUFFER, PIXEL_UNPACK_BUFFER, NUM_BUFFER_TARGETS };
+
+	GLuint _program = UNKNOWN;
+	GLuint _vao = UNKNOWN;
+	int _activeTextureUnit = -1;
+	GLuint _textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+	GLuint _buffers[NUM_BUFFER_TARGETS];
+	GLuint _uniformBufferBindings[MAX_BUFFER_BINDINGS];
+	GLuint _storageBufferBindings[MAX_BUFFER_BINDINGS];
+	Counters _counters;
+
+	GLStateCache();
+
+	/** \brief Gets shadow slot of given target, or -1 if the target is not shadowed. */
+	static int getTextureTargetSlot(GLenum target);
+	static int getBufferTargetSlot(GLenum target);
+
+	/** \brief Counts the call and tells, if it must be issued. */
+	bool needsUpdate(GLuint& shadowed, GLuint value);
+};
+#endif
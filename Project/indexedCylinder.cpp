@@ -0,0 +1,225 @@
+// STL
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "glStateCache.h"
+#include "indexedCylinder.h"
+
+
+
+namespace static_meshes_3D {
+
+	IndexedCylinder::IndexedCylinder(float radius, int numSlices, float height, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+		: StaticMeshIndexed3D(withPositions, withTextureCoordinates, withNormals, vertexLayout)
+		, _radius(radius)
+		, _numSlices(numSlices)
+		, _height(height)
+	{
+		initializeData();
+	}
+
+	float IndexedCylinder::getRadius() const
+	{
+		return _radius;
+	}
+
+	int IndexedCylinder::getSlices() const
+	{
+		return _numSlices;
+	}
+
+	float IndexedCylinder::getHeight() const
+	{
+		return _height;
+	}
+
+	void IndexedCylinder::initializeData()
+	{
+		if (_isInitialized) {
+			return;
+		}
+
+		// Side needs its own ring vertices because of different normals, but every cover is only
+		// a ring of _numSlices vertices without center and without duplicated seam vertex
+		const auto numVerticesSide = (_numSlices + 1) * 2;
+		const auto numVerticesCover = _numSlices;
+		_numVertices = numVerticesSide + numVerticesCover * 2;
+		_numIndices = numVerticesSide + numVerticesCover * 2 + 2; // Two primitive restarts between the strips
+		_primitiveRestartIndex = _numVertices;
+
+		// Generate VAO and VBOs for vertex attributes and indices
+		glGenVertexArrays(1, &_vao);
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		_vbo.createVBO(getVertexByteSize() * _numVertices);
+		_indicesVBO.createVBO(sizeof(GLuint) * _numIndices);
+
+		// Pre-calculate sines / cosines for given number of slices
+		const auto sliceAngleStep = 2.0f * glm::pi<float>() / float(_numSlices);
+		auto currentSliceAngle = 0.0f;
+		std::vector<float> sines, cosines;
+		for (auto i = 0; i <= _numSlices; i++)
+		{
+			sines.push_back(sin(currentSliceAngle));
+			cosines.push_back(cos(currentSliceAngle));
+
+			// Update slice angle
+			currentSliceAngle += sliceAngleStep;
+		}
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> textureCoordinates;
+		std::vector<glm::vec3> normals;
+
+		if (hasPositions())
+		{
+			positions.reserve(_numVertices);
+
+			// Add cylinder side vertices
+			for (auto i = 0; i <= _numSlices; i++)
+			{
+				positions.push_back(glm::vec3(cosines[i] * _radius, _height / 2.0f, sines[i] * _radius));
+				positions.push_back(glm::vec3(cosines[i] * _radius, -_height / 2.0f, sines[i] * _radius));
+			}
+
+			// Add top cylinder cover ring
+			for (auto i = 0; i < _numSlices; i++) {
+				positions.push_back(glm::vec3(cosines[i] * _radius, _height / 2.0f, sines[i] * _radius));
+			}
+
+			// Add bottom cylinder cover ring, mirrored so that it faces down
+			for (auto i = 0; i < _numSlices; i++) {
+				positions.push_back(glm::vec3(cosines[i] * _radius, -_height / 2.0f, -sines[i] * _radius));
+			}
+		}
+
+		if (hasTextureCoordinates())
+		{
+			textureCoordinates.reserve(_numVertices);
+
+			// Texture is mapped twice around cylinder, same as with non-indexed cylinder
+			const auto sliceTextureStepU = 2.0f / float(_numSlices);
+
+			auto currentSliceTexCoordU = 0.0f;
+			for (auto i = 0; i <= _numSlices; i++)
+			{
+				textureCoordinates.push_back(glm::vec2(currentSliceTexCoordU, 1.0f));
+				textureCoordinates.push_back(glm::vec2(currentSliceTexCoordU, 0.0f));
+
+				// Update texture coordinate of current slice
+				currentSliceTexCoordU += sliceTextureStepU;
+			}
+
+			// Generate circle texture coordinates for cylinder top cover
+			for (auto i = 0; i < _numSlices; i++) {
+				textureCoordinates.push_back(glm::vec2(0.5f + sines[i] * 0.5f, 0.5f + cosines[i] * 0.5f));
+			}
+
+			// Generate circle texture coordinates for cylinder bottom cover
+			for (auto i = 0; i < _numSlices; i++) {
+				textureCoordinates.push_back(glm::vec2(0.5f + sines[i] * 0.5f, 0.5f - cosines[i] * 0.5f));
+			}
+		}
+
+		if (hasNormals())
+		{
+			normals.reserve(_numVertices);
+			for (auto i = 0; i <= _numSlices; i++)
+			{
+				normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
+				normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
+			}
+
+			normals.insert(normals.end(), numVerticesCover, glm::vec3(0.0f, 1.0f, 0.0f));
+			normals.insert(normals.end(), numVerticesCover, glm::vec3(0.0f, -1.0f, 0.0f));
+		}
+
+		addVertexData(positions, textureCoordinates, normals);
+
+		// Bounding volumes follow directly from the dimensions, even if the mesh has no positions
+		_bounds.min = glm::vec3(-_radius, -_height / 2.0f, -_radius);
+		_bounds.max = glm::vec3(_radius, _height / 2.0f, _radius);
+		_boundingSphere.center = glm::vec3(0.0f);
+		_boundingSphere.radius = sqrt(_radius * _radius + _height * _height / 4.0f);
+
+		// Side is a plain strip going around the cylinder
+		for (auto i = 0; i < numVerticesSide; i++) {
+			_indicesVBO.addData(GLuint(i));
+		}
+
+		// Covers are convex polygons, so they can be triangulated as a strip zig-zagging across the ring
+		// (0, 1, n-1, 2, n-2, ...), which keeps the same winding as a fan around the center would
+		for (auto cover = 0; cover < 2; cover++)
+		{
+			const auto firstIndex = GLuint(numVerticesSide + cover * numVerticesCover);
+			_indicesVBO.addData(GLuint(_primitiveRestartIndex));
+			_indicesVBO.addData(firstIndex);
+
+			auto low = 1;
+			auto high = _numSlices - 1;
+			while (low <= high)
+			{
+				_indicesVBO.addData(firstIndex + low++);
+				if (low <= high) {
+					_indicesVBO.addData(firstIndex + high--);
+				}
+			}
+		}
+
+		// Finally upload data to the GPU
+		_vbo.bindVBO();
+		_vbo.uploadDataToGPU(GL_STATIC_DRAW);
+		setVertexAttributesPointers(_numVertices);
+
+		_indicesVBO.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+		_indicesVBO.uploadDataToGPU(GL_STATIC_DRAW);
+
+		_isInitialized = true;
+	}
+
+	void IndexedCylinder::render() const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(_primitiveRestartIndex);
+
+		// Side and both covers in one go
+		glDrawElements(GL_TRIANGLE_STRIP, _numIndices, GL_UNSIGNED_INT, 0);
+
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+
+	void IndexedCylinder::renderInstanced(int numInstances) const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(_primitiveRestartIndex);
+
+		glDrawElementsInstanced(GL_TRIANGLE_STRIP, _numIndices, GL_UNSIGNED_INT, 0, numInstances);
+
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+
+	void IndexedCylinder::renderPoints() const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		// Just render all points as they are stored in the VBO
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glDrawArrays(GL_POINTS, 0, _numVertices);
+	}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,46 @@
+#ifndef INDEXED_CYLINDER_H
+#define INDEXED_CYLINDER_H
+#include "common/staticMeshIndexed3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Cylinder static mesh with given radius, number of slices and height, rendered with indexed rendering.
+	* Side and both covers are triangle strips joined by primitive restart, so whole cylinder is a single draw call.
+	*/
+	class IndexedCylinder : public StaticMeshIndexed3D
+	{
+	public:
+		IndexedCylinder(float radius, int numSlices, float height,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar);
+
+		void render() const override;
+		void renderPoints() const override;
+		void renderInstanced(int numInstances) const override;
+
+		/**
+		 * Gets cylinder radius.
+		 */
+		float getRadius() const;
+
+		/**
+		 * Gets number of cylinder slices.
+		 */
+		int getSlices() const;
+
+		/**
+		 * Gets cylinder height.
+		 */
+		float getHeight() const;
+
+	private:
+		float _radius; // Cylinder radius (distance from the center of cylinder to surface)
+		int _numSlices; // Number of cylinder slices
+		float _height; // Height of the cylinder
+
+		void initializeData() override;
+	};
+
+} // namespace static_meshes_3D
+#endif
@@ -0,0 +1,180 @@
+// STL
+#include <cstddef>
+#include <iostream>
+
+// Project
+#include "glStateCache.h"
+#include "indirectDrawList.h"
+
+namespace static_meshes_3D {
+
+	const int IndirectDrawList::DRAW_ID_ATTRIBUTE_INDEX = 8;
+	const GLuint IndirectDrawList::DRAW_DATA_BINDING = 1;
+
+	IndirectDrawList::IndirectDrawList(const GeometryArena& arena, const MaterialAtlas& materialAtlas)
+		: _arena(arena)
+		, _materialAtlas(materialAtlas)
+	{
+	}
+
+	IndirectDrawList::~IndirectDrawList()
+	{
+		deleteList();
+	}
+
+	int IndirectDrawList::addDraw(const GeometryRange& range, const glm::mat4& modelMatrix, int materialIndex)
+	{
+		if (_isUploaded)
+		{
+			std::cerr << "Cannot add draws to indirect draw list, that has been uploaded already!" << std::endl;
+			return -1;
+		}
+
+		_draws.push_back({ range, modelMatrix, materialIndex });
+		return int(_draws.size()) - 1;
+	}
+
+	void IndirectDrawList::setModelMatrix(int drawIndex, const glm::mat4& modelMatrix)
+	{
+		_draws[drawIndex].modelMatrix = modelMatrix;
+		if (_isUploaded)
+		{
+			_drawDataVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUDrawData) * drawIndex + offsetof(GPUDrawData, modelMatrix),
+				sizeof(glm::mat4), &modelMatrix);
+		}
+	}
+
+	glm::mat4* IndirectDrawList::mapModelMatrices(size_t& stride)
+	{
+		stride = sizeof(GPUDrawData);
+		if (!_isUploaded) {
+			return nullptr;
+		}
+
+		// Only changed matrices are written, so the rest of the buffer must stay intact (no invalidation)
+		_drawDataVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+		auto drawData = static_cast<unsigned char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+			sizeof(GPUDrawData) * _draws.size(), GL_MAP_WRITE_BIT));
+		if (drawData == nullptr) {
+			return nullptr;
+		}
+
+		return reinterpret_cast<glm::mat4*>(drawData + offsetof(GPUDrawData, modelMatrix));
+	}
+
+	void IndirectDrawList::unmapModelMatrices()
+	{
+		_drawDataVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	}
+
+	void IndirectDrawList::setDrawVisible(int drawIndex, bool isVisible)
+	{
+		if (!_isUploaded) {
+			return;
+		}
+
+		const auto instanceCount = isVisible ? 1u : 0u;
+		if (_commands[drawIndex].instanceCount != instanceCount)
+		{
+			_commands[drawIndex].instanceCount = instanceCount;
+			_areCommandsDirty = true;
+		}
+	}
+
+	void IndirectDrawList::uploadToGPU()
+	{
+		if (_isUploaded || _draws.empty()) {
+			return;
+		}
+
+		std::vector<GPUDrawData> gpuDrawData;
+		_commands.clear();
+		_commandsVBO.createVBO(sizeof(DrawArraysIndirectCommand) * _draws.size());
+		_drawIdsVBO.createVBO(sizeof(GLuint) * _draws.size());
+
+		for (size_t i = 0; i < _draws.size(); i++)
+		{
+			const auto& draw = _draws[i];
+			const auto& material = _materialAtlas.getMaterial(draw.materialIndex);
+
+			GPUDrawData drawData;
+			drawData.modelMatrix = draw.modelMatrix;
+			drawData.uvRect = material.uvRect;
+			drawData.layer = float(material.layer);
+			drawData.padding[0] = drawData.padding[1] = drawData.padding[2] = 0.0f;
+			gpuDrawData.push_back(drawData);
+
+			// Base instance selects the draw ID, which in turn selects the per-draw data
+			DrawArraysIndirectCommand command;
+			command.count = GLuint(draw.range.count);
+			command.instanceCount = 1;
+			command.first = GLuint(draw.range.baseVertex);
+			command.baseInstance = GLuint(i);
+			_commands.push_back(command);
+			_drawIdsVBO.addData(GLuint(i));
+		}
+
+		_commandsVBO.addRawData(_commands.data(), sizeof(DrawArraysIndirectCommand) * _commands.size());
+		_commandsVBO.bindVBO(GL_DRAW_INDIRECT_BUFFER);
+		_commandsVBO.uploadDataToGPU(GL_DYNAMIC_DRAW);
+
+		_drawDataVBO.createVBO(sizeof(GPUDrawData) * gpuDrawData.size());
+		_drawDataVBO.addRawData(gpuDrawData.data(), sizeof(GPUDrawData) * gpuDrawData.size());
+		_drawDataVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+		_drawDataVBO.uploadDataToGPU(GL_DYNAMIC_DRAW);
+
+		// Draw IDs are an instanced integer attribute of the arena VAO
+		GLStateCache::getInstance().bindVertexArray(_arena.getVAO());
+		_drawIdsVBO.bindVBO();
+		_drawIdsVBO.uploadDataToGPU(GL_STATIC_DRAW);
+		glEnableVertexAttribArray(DRAW_ID_ATTRIBUTE_INDEX);
+		glVertexAttribIPointer(DRAW_ID_ATTRIBUTE_INDEX, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+		glVertexAttribDivisor(DRAW_ID_ATTRIBUTE_INDEX, 1);
+
+		_isUploaded = true;
+		_areCommandsDirty = false;
+	}
+
+	void IndirectDrawList::render()
+	{
+		if (!_isUploaded) {
+			return;
+		}
+
+		auto& glState = GLStateCache::getInstance();
+		glState.bindVertexArray(_arena.getVAO());
+
+		glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, _drawDataVBO.getBufferID());
+
+		_commandsVBO.bindVBO(GL_DRAW_INDIRECT_BUFFER);
+		if (_areCommandsDirty)
+		{
+			// Commands are 16 bytes each, so uploading all of them is cheaper than tracking changed ranges
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawArraysIndirectCommand) * _commands.size(), _commands.data());
+			_areCommandsDirty = false;
+		}
+		glState.activeTexture(GL_TEXTURE0);
+		glState.bindTexture(GL_TEXTURE_2D_ARRAY, _materialAtlas.getTexture());
+		glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, GLsizei(_draws.size()), 0);
+	}
+
+	int IndirectDrawList::getNumDraws() const
+	{
+		return int(_draws.size());
+	}
+
+	void IndirectDrawList::deleteList()
+	{
+		if (!_isUploaded) {
+			return;
+		}
+
+		_commandsVBO.deleteVBO();
+		_drawDataVBO.deleteVBO();
+		_drawIdsVBO.deleteVBO();
+		_isUploaded = false;
+	}
+
+} // namespace static_meshes_3D
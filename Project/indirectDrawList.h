@@ -0,0 +1,103 @@
+#ifndef INDIRECT_DRAW_LIST_H
+#define INDIRECT_DRAW_LIST_H
+
+// STL
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "geometryArena.h"
+#include "materialAtlas.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Renders many static draws of geometry arena ranges with a single glMultiDrawArraysIndirect call.
+	* Draw commands live in a GL_DRAW_INDIRECT_BUFFER and per-draw data (model matrix and material placement
+	* within the material atlas) in a shader storage buffer, which the vertex shader indexes with a per-draw ID
+	* attribute (fed through base instance of every command). All materials come from one texture array,
+	* so there are no texture switches between the draws.
+	*/
+	class IndirectDrawList
+	{
+	public:
+		static const int DRAW_ID_ATTRIBUTE_INDEX; //!< Vertex attribute index of per-draw ID (8)
+		static const GLuint DRAW_DATA_BINDING; //!< Shader storage buffer binding point of per-draw data (1)
+
+		IndirectDrawList(const GeometryArena& arena, const MaterialAtlas& materialAtlas);
+		~IndirectDrawList();
+
+		/** \brief  Adds draw of arena range. Must be called before uploading to the GPU.
+		*   \return Index of the draw, used to update its model matrix later.
+		*/
+		int addDraw(const GeometryRange& range, const glm::mat4& modelMatrix, int materialIndex);
+
+		/** \brief  Updates model matrix of existing draw, writing it to the GPU right away, if list has been uploaded. */
+		void setModelMatrix(int drawIndex, const glm::mat4& modelMatrix);
+
+		/** \brief  Maps per-draw data for writing model matrices directly, e.g. by TransformSystem::writeOutput.
+		*   \param stride  Receives distance between model matrices of consecutive draws in bytes.
+		*   \return Model matrix of the first draw, nullptr if list is not uploaded or mapping failed.
+		*/
+		glm::mat4* mapModelMatrices(size_t& stride);
+
+		/** \brief  Unmaps per-draw data mapped by mapModelMatrices. Must be called before rendering. */
+		void unmapModelMatrices();
+
+		/** \brief  Shows or hides draw, e.g. after frustum culling. Hidden draws stay in the list with zero instances. */
+		void setDrawVisible(int drawIndex, bool isVisible);
+
+		/** \brief  Builds draw commands and uploads them together with per-draw data to the GPU. Material atlas must be built already. */
+		void uploadToGPU();
+
+		/** \brief  Renders all draws with one multi-draw call. Material atlas is bound to texture unit 0. */
+		void render();
+
+		/** \brief  Gets number of draws in the list. */
+		int getNumDraws() const;
+
+		/** \brief  Deletes draw list data from the GPU. */
+		void deleteList();
+
+	private:
+		// Layout of glMultiDrawArraysIndirect command, defined by OpenGL
+		struct DrawArraysIndirectCommand
+		{
+			GLuint count;
+			GLuint instanceCount;
+			GLuint first;
+			GLuint baseInstance;
+		};
+
+		struct DrawData
+		{
+			GeometryRange range;
+			glm::mat4 modelMatrix;
+			int materialIndex;
+		};
+
+		// Per-draw data as laid out in the shader storage buffer (std430)
+		struct GPUDrawData
+		{
+			glm::mat4 modelMatrix;
+			glm::vec4 uvRect;
+			float layer;
+			float padding[3];
+		};
+
+		const GeometryArena& _arena; // Arena, whose ranges are drawn
+		const MaterialAtlas& _materialAtlas; // Atlas, that contains materials of all draws
+		std::vector<DrawData> _draws; // Draws in order of adding
+		std::vector<DrawArraysIndirectCommand> _commands; // Draw commands in order of adding
+
+		VertexBufferObject _commandsVBO; // Indirect draw commands
+		VertexBufferObject _drawDataVBO; // Shader storage buffer with per-draw data
+		VertexBufferObject _drawIdsVBO; // Per-draw IDs 0..N-1, fetched per instance
+		bool _isUploaded = false; // Flag telling, if data has been uploaded to GPU already
+		bool _areCommandsDirty = false; // Flag telling, if visibility of draws changed and commands must be uploaded again
+	};
+
+} // namespace static_meshes_3D
+#endif
@@ -0,0 +1,109 @@
+// STL
+#include <cstddef>
+
+// Project
+#include "glStateCache.h"
+#include "instancedBatch.h"
+
+namespace static_meshes_3D {
+
+	const int InstancedBatch::MODEL_MATRIX_ATTRIBUTE_INDEX = 3;
+	const int InstancedBatch::TEXTURE_LAYER_ATTRIBUTE_INDEX = 7;
+
+	InstancedBatch::InstancedBatch(std::shared_ptr<const StaticMesh3D> mesh)
+		: _mesh(std::move(mesh))
+	{
+		_instancesVBO.createVBO();
+	}
+
+	InstancedBatch::~InstancedBatch()
+	{
+		deleteBatch();
+	}
+
+	int InstancedBatch::addInstance(const glm::mat4& modelMatrix, float textureLayer)
+	{
+		_instances.push_back({ modelMatrix, textureLayer });
+		_isDirty = true;
+		return int(_instances.size()) - 1;
+	}
+
+	void InstancedBatch::setInstance(int index, const glm::mat4& modelMatrix, float textureLayer)
+	{
+		_instances[index] = { modelMatrix, textureLayer };
+		_isDirty = true;
+	}
+
+	glm::mat4* InstancedBatch::mapModelMatrices(size_t& stride)
+	{
+		// Instances are uploaded as a whole anyway, so matrices are written to the CPU side copy
+		stride = sizeof(InstanceData);
+		if (_instances.empty()) {
+			return nullptr;
+		}
+
+		_isDirty = true;
+		return &_instances[0].modelMatrix;
+	}
+
+	void InstancedBatch::unmapModelMatrices()
+	{
+	}
+
+	void InstancedBatch::clearInstances()
+	{
+		_instances.clear();
+		_isDirty = true;
+	}
+
+	int InstancedBatch::getNumInstances() const
+	{
+		return int(_instances.size());
+	}
+
+	void InstancedBatch::render()
+	{
+		if (!_mesh || _instances.empty()) {
+			return;
+		}
+
+		// Instance attributes are attached to the mesh VAO, which might be shared with other batches,
+		// so pointers are set every time before rendering
+		GLStateCache::getInstance().bindVertexArray(_mesh->getVAO());
+		_instancesVBO.bindVBO();
+		if (_isDirty)
+		{
+			_instancesVBO.addRawData(_instances.data(), sizeof(InstanceData) * _instances.size());
+			_instancesVBO.uploadDataToGPU(GL_DYNAMIC_DRAW);
+			_isDirty = false;
+		}
+		setInstanceAttributesPointers();
+
+		_mesh->renderInstanced(int(_instances.size()));
+	}
+
+	void InstancedBatch::deleteBatch()
+	{
+		_instancesVBO.deleteVBO();
+		_mesh.reset();
+	}
+
+	void InstancedBatch::setInstanceAttributesPointers()
+	{
+		// Matrix takes four consecutive attribute locations, one per column
+		for (auto column = 0; column < 4; column++)
+		{
+			const auto attributeIndex = MODEL_MATRIX_ATTRIBUTE_INDEX + column;
+			glEnableVertexAttribArray(attributeIndex);
+			glVertexAttribPointer(attributeIndex, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+				reinterpret_cast<void*>(offsetof(InstanceData, modelMatrix) + sizeof(glm::vec4) * column));
+			glVertexAttribDivisor(attributeIndex, 1);
+		}
+
+		glEnableVertexAttribArray(TEXTURE_LAYER_ATTRIBUTE_INDEX);
+		glVertexAttribPointer(TEXTURE_LAYER_ATTRIBUTE_INDEX, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			reinterpret_cast<void*>(offsetof(InstanceData, textureLayer)));
+		glVertexAttribDivisor(TEXTURE_LAYER_ATTRIBUTE_INDEX, 1);
+	}
+
+} // namespace static_meshes_3D
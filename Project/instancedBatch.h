@@ -0,0 +1,75 @@
+#ifndef INSTANCED_BATCH_H
+#define INSTANCED_BATCH_H
+
+// STL
+#include <memory>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "common/staticMesh3D.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Renders many copies of one static mesh with a single instanced draw call.
+	* Every instance has its own model matrix and texture layer index, stored in a per-instance VBO.
+	*/
+	class InstancedBatch
+	{
+	public:
+		static const int MODEL_MATRIX_ATTRIBUTE_INDEX; //!< First vertex attribute index of instance model matrix (3, takes 3 - 6)
+		static const int TEXTURE_LAYER_ATTRIBUTE_INDEX; //!< Vertex attribute index of instance texture layer (7)
+
+		InstancedBatch(std::shared_ptr<const StaticMesh3D> mesh);
+		~InstancedBatch();
+
+		/** \brief  Adds new instance to the batch.
+		*   \return Index of the added instance.
+		*/
+		int addInstance(const glm::mat4& modelMatrix, float textureLayer = 0.0f);
+
+		/** \brief  Updates model matrix and texture layer of existing instance. */
+		void setInstance(int index, const glm::mat4& modelMatrix, float textureLayer = 0.0f);
+
+		/** \brief  Gives write access to model matrices of all instances, e.g. for TransformSystem::writeOutput.
+		*          Instance data are uploaded on next render.
+		*   \param stride  Receives distance between model matrices of consecutive instances in bytes.
+		*   \return Model matrix of the first instance, nullptr if batch has no instances.
+		*/
+		glm::mat4* mapModelMatrices(size_t& stride);
+
+		/** \brief  Ends write access started by mapModelMatrices. */
+		void unmapModelMatrices();
+
+		/** \brief  Removes all instances from the batch. */
+		void clearInstances();
+
+		/** \brief  Gets number of instances in the batch. */
+		int getNumInstances() const;
+
+		/** \brief  Renders all instances, uploading instance data first if they have changed. */
+		void render();
+
+		/** \brief  Deletes instance data from the GPU and releases the mesh. */
+		void deleteBatch();
+
+	private:
+		struct InstanceData
+		{
+			glm::mat4 modelMatrix;
+			float textureLayer;
+		};
+
+		std::shared_ptr<const StaticMesh3D> _mesh; // Mesh, that is rendered for every instance
+		std::vector<InstanceData> _instances; // Instance data gathered on the CPU side
+		VertexBufferObject _instancesVBO; // Per-instance attributes on the GPU side
+		bool _isDirty = true; // Flag telling, if instance data must be uploaded again
+
+		void setInstanceAttributesPointers();
+	};
+
+} // namespace static_meshes_3D
+#endif
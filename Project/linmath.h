@@ -11,6 +11,17 @@
 #define LINMATH_H_FUNC static inline
 #endif
 
+/* SIMD kernels are selected at compile time, define LINMATH_NO_SIMD to force the scalar code.
+ * They perform the same operations in the same order as the scalar code (no fused multiply-add),
+ * so the results are identical to it. */
+#if !defined(LINMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LINMATH_SSE2
+#include <emmintrin.h>
+#elif !defined(LINMATH_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define LINMATH_NEON
+#include <arm_neon.h>
+#endif
+
 #define LINMATH_H_DEFINE_VEC(n) \
 typedef float vec##n[n]; \
 LINMATH_H_FUNC void vec##n##_add(vec##n r, vec##n const a, vec##n const b) \
@@ -125,10 +136,28 @@ LINMATH_H_FUNC void mat4x4_col(vec4 r, mat4x4 M, int i)
 }
 LINMATH_H_FUNC void mat4x4_transpose(mat4x4 M, mat4x4 N)
 {
+#if defined(LINMATH_SSE2)
+	__m128 c0 = _mm_loadu_ps(N[0]);
+	__m128 c1 = _mm_loadu_ps(N[1]);
+	__m128 c2 = _mm_loadu_ps(N[2]);
+	__m128 c3 = _mm_loadu_ps(N[3]);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	_mm_storeu_ps(M[0], c0);
+	_mm_storeu_ps(M[1], c1);
+	_mm_storeu_ps(M[2], c2);
+	_mm_storeu_ps(M[3], c3);
+#elif defined(LINMATH_NEON)
+	float32x4x4_t t = vld4q_f32(&N[0][0]);
+	vst1q_f32(M[0], t.val[0]);
+	vst1q_f32(M[1], t.val[1]);
+	vst1q_f32(M[2], t.val[2]);
+	vst1q_f32(M[3], t.val[3]);
+#else
 	int i, j;
 	for (j = 0; j < 4; ++j)
 		for (i = 0; i < 4; ++i)
 			M[i][j] = N[j][i];
+#endif
 }
 LINMATH_H_FUNC void mat4x4_add(mat4x4 M, mat4x4 a, mat4x4 b)
 {
@@ -160,6 +189,44 @@ LINMATH_H_FUNC void mat4x4_scale_aniso(mat4x4 M, mat4x4 a, float x, float y, flo
 }
 LINMATH_H_FUNC void mat4x4_mul(mat4x4 M, mat4x4 a, mat4x4 b)
 {
+#if defined(LINMATH_SSE2)
+	/* Column c of the result is the sum of columns of a weighted by column c of b */
+	__m128 const a0 = _mm_loadu_ps(a[0]);
+	__m128 const a1 = _mm_loadu_ps(a[1]);
+	__m128 const a2 = _mm_loadu_ps(a[2]);
+	__m128 const a3 = _mm_loadu_ps(a[3]);
+	__m128 temp[4];
+	int c;
+	for (c = 0; c < 4; ++c) {
+		__m128 const bc = _mm_loadu_ps(b[c]);
+		__m128 r = _mm_setzero_ps();
+		r = _mm_add_ps(r, _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0))));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3))));
+		temp[c] = r;
+	}
+	for (c = 0; c < 4; ++c)
+		_mm_storeu_ps(M[c], temp[c]);
+#elif defined(LINMATH_NEON)
+	/* Separate multiply and add, fused multiply-add would round differently than the scalar code */
+	float32x4_t const a0 = vld1q_f32(a[0]);
+	float32x4_t const a1 = vld1q_f32(a[1]);
+	float32x4_t const a2 = vld1q_f32(a[2]);
+	float32x4_t const a3 = vld1q_f32(a[3]);
+	float32x4_t temp[4];
+	int c;
+	for (c = 0; c < 4; ++c) {
+		float32x4_t r = vdupq_n_f32(0.f);
+		r = vaddq_f32(r, vmulq_n_f32(a0, b[c][0]));
+		r = vaddq_f32(r, vmulq_n_f32(a1, b[c][1]));
+		r = vaddq_f32(r, vmulq_n_f32(a2, b[c][2]));
+		r = vaddq_f32(r, vmulq_n_f32(a3, b[c][3]));
+		temp[c] = r;
+	}
+	for (c = 0; c < 4; ++c)
+		vst1q_f32(M[c], temp[c]);
+#else
 	mat4x4 temp;
 	int k, r, c;
 	for (c = 0; c < 4; ++c) for (r = 0; r < 4; ++r) {
@@ -168,15 +235,33 @@ LINMATH_H_FUNC void mat4x4_mul(mat4x4 M, mat4x4 a, mat4x4 b)
 			temp[c][r] += a[k][r] * b[c][k];
 	}
 	mat4x4_dup(M, temp);
+#endif
 }
 LINMATH_H_FUNC void mat4x4_mul_vec4(vec4 r, mat4x4 M, vec4 v)
 {
+#if defined(LINMATH_SSE2)
+	__m128 const vv = _mm_loadu_ps(v);
+	__m128 t = _mm_setzero_ps();
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[0]), _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(0, 0, 0, 0))));
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[1]), _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(1, 1, 1, 1))));
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[2]), _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(2, 2, 2, 2))));
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[3]), _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(3, 3, 3, 3))));
+	_mm_storeu_ps(r, t);
+#elif defined(LINMATH_NEON)
+	float32x4_t t = vdupq_n_f32(0.f);
+	t = vaddq_f32(t, vmulq_n_f32(vld1q_f32(M[0]), v[0]));
+	t = vaddq_f32(t, vmulq_n_f32(vld1q_f32(M[1]), v[1]));
+	t = vaddq_f32(t, vmulq_n_f32(vld1q_f32(M[2]), v[2]));
+	t = vaddq_f32(t, vmulq_n_f32(vld1q_f32(M[3]), v[3]));
+	vst1q_f32(r, t);
+#else
 	int i, j;
 	for (j = 0; j < 4; ++j) {
 		r[j] = 0.f;
 		for (i = 0; i < 4; ++i)
 			r[j] += M[i][j] * v[i];
 	}
+#endif
 }
 LINMATH_H_FUNC void mat4x4_translate(mat4x4 T, float x, float y, float z)
 {
@@ -293,6 +378,40 @@ LINMATH_H_FUNC void mat4x4_invert(mat4x4 T, mat4x4 M)
 	/* Assumes it is invertible */
 	float idet = 1.0f / (s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0]);
 
+#if defined(LINMATH_SSE2)
+	/* Every column of T is sign * ((X * A - Y * B) + Z * C) * idet per lane, where X, Y, Z are rows of M
+	 * with lanes ordered (1, 0, 3, 2) and A, B, C pair c[] (first two lanes) with s[] (last two lanes).
+	 * Negating a whole sum rounds the same as the scalar code negating its first product. */
+	__m128 p0 = _mm_loadu_ps(M[0]);
+	__m128 p1 = _mm_loadu_ps(M[1]);
+	__m128 p2 = _mm_loadu_ps(M[2]);
+	__m128 p3 = _mm_loadu_ps(M[3]);
+	_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+	p0 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(2, 3, 0, 1));
+	p1 = _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(2, 3, 0, 1));
+	p2 = _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(2, 3, 0, 1));
+	p3 = _mm_shuffle_ps(p3, p3, _MM_SHUFFLE(2, 3, 0, 1));
+
+	__m128 const cs0 = _mm_setr_ps(c[0], c[0], s[0], s[0]);
+	__m128 const cs1 = _mm_setr_ps(c[1], c[1], s[1], s[1]);
+	__m128 const cs2 = _mm_setr_ps(c[2], c[2], s[2], s[2]);
+	__m128 const cs3 = _mm_setr_ps(c[3], c[3], s[3], s[3]);
+	__m128 const cs4 = _mm_setr_ps(c[4], c[4], s[4], s[4]);
+	__m128 const cs5 = _mm_setr_ps(c[5], c[5], s[5], s[5]);
+	__m128 const sign_odd = _mm_castsi128_ps(_mm_setr_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+	__m128 const sign_even = _mm_castsi128_ps(_mm_setr_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+	__m128 const videt = _mm_set1_ps(idet);
+
+	__m128 t0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p1, cs5), _mm_mul_ps(p2, cs4)), _mm_mul_ps(p3, cs3));
+	__m128 t1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p0, cs5), _mm_mul_ps(p2, cs2)), _mm_mul_ps(p3, cs1));
+	__m128 t2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p0, cs4), _mm_mul_ps(p1, cs2)), _mm_mul_ps(p3, cs0));
+	__m128 t3 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p0, cs3), _mm_mul_ps(p1, cs1)), _mm_mul_ps(p2, cs0));
+	_mm_storeu_ps(T[0], _mm_mul_ps(_mm_xor_ps(t0, sign_odd), videt));
+	_mm_storeu_ps(T[1], _mm_mul_ps(_mm_xor_ps(t1, sign_even), videt));
+	_mm_storeu_ps(T[2], _mm_mul_ps(_mm_xor_ps(t2, sign_odd), videt));
+	_mm_storeu_ps(T[3], _mm_mul_ps(_mm_xor_ps(t3, sign_even), videt));
+#else
+
 	T[0][0] = (M[1][1] * c[5] - M[1][2] * c[4] + M[1][3] * c[3]) * idet;
 	T[0][1] = (-M[0][1] * c[5] + M[0][2] * c[4] - M[0][3] * c[3]) * idet;
 	T[0][2] = (M[3][1] * s[5] - M[3][2] * s[4] + M[3][3] * s[3]) * idet;
@@ -312,6 +431,7 @@ LINMATH_H_FUNC void mat4x4_invert(mat4x4 T, mat4x4 M)
 	T[3][1] = (M[0][0] * c[3] - M[0][1] * c[1] + M[0][2] * c[0]) * idet;
 	T[3][2] = (-M[3][0] * s[3] + M[3][1] * s[1] - M[3][2] * s[0]) * idet;
 	T[3][3] = (M[2][0] * s[3] - M[2][1] * s[1] + M[2][2] * s[0]) * idet;
+#endif
 }
 LINMATH_H_FUNC void mat4x4_orthonormalize(mat4x4 R, mat4x4 M)
 {
@@ -456,6 +576,21 @@ LINMATH_H_FUNC void quat_sub(quat r, quat a, quat b)
 }
 LINMATH_H_FUNC void quat_mul(quat r, quat p, quat q)
 {
+#if defined(LINMATH_SSE2)
+	/* xyz = cross(p, q) + p * q.w + q * p.w, w is computed as in the scalar code */
+	__m128 const vp = _mm_loadu_ps(p);
+	__m128 const vq = _mm_loadu_ps(q);
+	float const w = p[3] * q[3] - vec3_mul_inner(p, q);
+	__m128 const p_yzx = _mm_shuffle_ps(vp, vp, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 const p_zxy = _mm_shuffle_ps(vp, vp, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 const q_yzx = _mm_shuffle_ps(vq, vq, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 const q_zxy = _mm_shuffle_ps(vq, vq, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 t = _mm_sub_ps(_mm_mul_ps(p_yzx, q_zxy), _mm_mul_ps(p_zxy, q_yzx));
+	t = _mm_add_ps(t, _mm_mul_ps(vp, _mm_set1_ps(q[3])));
+	t = _mm_add_ps(t, _mm_mul_ps(vq, _mm_set1_ps(p[3])));
+	_mm_storeu_ps(r, t);
+	r[3] = w;
+#else
 	vec3 w;
 	vec3_mul_cross(r, p, q);
 	vec3_scale(w, p, q[3]);
@@ -463,6 +598,7 @@ LINMATH_H_FUNC void quat_mul(quat r, quat p, quat q)
 	vec3_scale(w, q, p[3]);
 	vec3_add(r, r, w);
 	r[3] = p[3] * q[3] - vec3_mul_inner(p, q);
+#endif
 }
 LINMATH_H_FUNC void quat_scale(quat r, quat v, float s)
 {
@@ -0,0 +1,167 @@
+// Project
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	_fileHandle = file;
+	_mappingHandle = mapping;
+	_data = static_cast<const unsigned char*>(view);
+	_size = size_t(size.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data == nullptr) {
+		return;
+	}
+
+	UnmapViewOfFile(_data);
+	CloseHandle(_mappingHandle);
+	CloseHandle(_fileHandle);
+	_fileHandle = nullptr;
+	_mappingHandle = nullptr;
+	_data = nullptr;
+	_size = 0;
+}
+
+bool getFileStamp(const std::string& path, FileStamp& stamp)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) {
+		return false;
+	}
+
+	stamp.size = (uint64_t(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+	stamp.modificationTime = int64_t((uint64_t(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime);
+	return true;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	const auto file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	const auto view = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// Mapping stays valid after the descriptor is closed
+	::close(file);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+
+	_data = static_cast<const unsigned char*>(view);
+	_size = size_t(fileStat.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data == nullptr) {
+		return;
+	}
+
+	munmap(const_cast<unsigned char*>(_data), _size);
+	_data = nullptr;
+	_size = 0;
+}
+
+bool getFileStamp(const std::string& path, FileStamp& stamp)
+{
+	struct stat fileStat;
+	if (stat(path.c_str(), &fileStat) != 0) {
+		return false;
+	}
+
+	stamp.size = uint64_t(fileStat.st_size);
+	stamp.modificationTime = int64_t(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+	return true;
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+	return _data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return _data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return _size;
+}
+
+uint64_t fnv1a64(const void* data, size_t numBytes)
+{
+	auto bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < numBytes; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
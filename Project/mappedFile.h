@@ -0,0 +1,67 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+* Read-only memory mapping of a whole file. The contents are paged in by the OS on access,
+* so nothing is copied until it is actually read.
+*/
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	/** \brief  Maps file into memory, closing previously mapped one.
+	*   \return True, if file has been mapped (empty files cannot be mapped).
+	*/
+	bool open(const std::string& path);
+
+	/** \brief  Unmaps file. */
+	void close();
+
+	/** \brief  Gets, if a file is mapped. */
+	bool isOpen() const;
+
+	/** \brief  Gets mapped contents of the file. */
+	const unsigned char* getData() const;
+
+	/** \brief  Gets size of the file in bytes. */
+	size_t getSize() const;
+
+private:
+	const unsigned char* _data = nullptr; // Start of the mapping
+	size_t _size = 0; // Size of the mapping
+#ifdef _WIN32
+	void* _fileHandle = nullptr; // Handle of the opened file
+	void* _mappingHandle = nullptr; // Handle of the file mapping object
+#endif
+};
+
+/**
+* Computes 64-bit FNV-1a hash of given bytes, used to detect changed content.
+*/
+uint64_t fnv1a64(const void* data, size_t numBytes);
+
+/**
+* Size and last modification time of a file, tells cheaply that a file has not changed without reading it.
+*/
+struct FileStamp
+{
+	uint64_t size = 0; //!< Size in bytes
+	int64_t modificationTime = 0; //!< Time of last write in platform specific units
+};
+
+/**
+* Gets size and last modification time of a file.
+* \return True, if the file exists.
+*/
+bool getFileStamp(const std::string& path, FileStamp& stamp);
+
+#endif
@@ -0,0 +1,180 @@
+// STL
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+// Project
+#include "glStateCache.h"
+#include "materialAtlas.h"
+#include "stb_image.h"
+#include "textureLoader.h"
+
+const int MaterialAtlas::PAGE_SIZE = 2048;
+const int MaterialAtlas::NUM_LEVELS = 5;
+const int MaterialAtlas::PADDING = 1 << (MaterialAtlas::NUM_LEVELS - 1);
+
+MaterialAtlas::~MaterialAtlas()
+{
+	deleteAtlas();
+}
+
+int MaterialAtlas::addMaterial(const std::string& path)
+{
+	if (_isBuilt)
+	{
+		std::cerr << "Cannot add materials to atlas, that has been built already!" << std::endl;
+		return -1;
+	}
+
+	// Images, that cannot be read or do not fit into a page, get a single texel of the placeholder color
+	int width, height, numChannels;
+	if (!stbi_info(path.c_str(), &width, &height, &numChannels))
+	{
+		std::cout << "Failure to read size of texture " << path << ": " << stbi_failure_reason() << std::endl;
+		width = height = 0;
+	}
+	else if (width + 2 * PADDING > PAGE_SIZE || height + 2 * PADDING > PAGE_SIZE)
+	{
+		std::cout << "Texture " << path << " does not fit into atlas page" << std::endl;
+		width = height = 0;
+	}
+
+	Material material;
+	material.path = width > 0 ? path : std::string();
+	material.width = std::max(width, 1);
+	material.height = std::max(height, 1);
+	material.layer = 0;
+	material.x = 0;
+	material.y = 0;
+	material.uvRect = glm::vec4(0.0f);
+	_materials.push_back(material);
+	return int(_materials.size()) - 1;
+}
+
+void MaterialAtlas::build(TextureLoader& textureLoader)
+{
+	if (_isBuilt || _materials.empty()) {
+		return;
+	}
+
+	pack();
+
+	auto& glState = GLStateCache::getInstance();
+	glGenTextures(1, &_texture);
+	glState.bindTexture(GL_TEXTURE_2D_ARRAY, _texture);
+
+	// Wrapping is done in the shader within the material rectangle
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, NUM_LEVELS - 1);
+	for (int level = 0; level < NUM_LEVELS; level++) {
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, PAGE_SIZE >> level, PAGE_SIZE >> level, _numLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	// Pages show placeholder color until the images arrive
+	std::vector<unsigned char> placeholderPage(size_t(PAGE_SIZE) * PAGE_SIZE * 4);
+	for (size_t i = 0; i < placeholderPage.size(); i += 4)
+	{
+		placeholderPage[i] = placeholderPage[i + 1] = placeholderPage[i + 2] = 128;
+		placeholderPage[i + 3] = 255;
+	}
+	for (int layer = 0; layer < _numLayers; layer++) {
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, PAGE_SIZE, PAGE_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPage.data());
+	}
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+	for (const auto& material : _materials)
+	{
+		if (!material.path.empty()) {
+			textureLoader.requestAtlasRegion(material.path, _texture, material.layer, material.x, material.y, material.width, material.height, PADDING);
+		}
+	}
+
+	_isBuilt = true;
+}
+
+GLuint MaterialAtlas::getTexture() const
+{
+	return _texture;
+}
+
+int MaterialAtlas::getNumLayers() const
+{
+	return _numLayers;
+}
+
+const MaterialAtlas::Material& MaterialAtlas::getMaterial(int materialIndex) const
+{
+	return _materials[materialIndex];
+}
+
+int MaterialAtlas::getNumMaterials() const
+{
+	return int(_materials.size());
+}
+
+void MaterialAtlas::deleteAtlas()
+{
+	if (!_isBuilt) {
+		return;
+	}
+
+	GLStateCache::getInstance().onTextureDeleted(_texture);
+	glDeleteTextures(1, &_texture);
+	_texture = 0;
+	_isBuilt = false;
+}
+
+void MaterialAtlas::pack()
+{
+	// Shelf packing: tallest materials first, placed left to right on shelves, shelves bottom to top.
+	// Padded rectangles are rounded up to whole blocks of the smallest mip level, so that they stay aligned to them
+	const auto alignment = 1 << (NUM_LEVELS - 1);
+	const auto alignUp = [alignment](int value) { return (value + alignment - 1) / alignment * alignment; };
+
+	std::vector<int> order(_materials.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		return _materials[a].height > _materials[b].height;
+	});
+
+	int layer = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	int cursorX = 0;
+	for (const auto index : order)
+	{
+		auto& material = _materials[index];
+		const auto paddedWidth = alignUp(material.width + 2 * PADDING);
+		const auto paddedHeight = alignUp(material.height + 2 * PADDING);
+
+		if (cursorX + paddedWidth > PAGE_SIZE)
+		{
+			// Shelf is full, open a new one above it
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+			cursorX = 0;
+		}
+		if (shelfY + paddedHeight > PAGE_SIZE)
+		{
+			// Page is full, continue on the next layer
+			layer++;
+			shelfY = 0;
+			shelfHeight = 0;
+			cursorX = 0;
+		}
+
+		material.layer = layer;
+		material.x = cursorX + PADDING;
+		material.y = shelfY + PADDING;
+		material.uvRect = glm::vec4(float(material.x), float(material.y), float(material.width), float(material.height)) / float(PAGE_SIZE);
+
+		cursorX += paddedWidth;
+		shelfHeight = std::max(shelfHeight, paddedHeight);
+	}
+
+	_numLayers = layer + 1;
+}
@@ -0,0 +1,81 @@
+#ifndef MATERIAL_ATLAS_H
+#define MATERIAL_ATLAS_H
+
+// STL
+#include <string>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include <glad/glad.h>
+
+class TextureLoader;
+
+/**
+* Packs material textures of any size into pages of one GL_TEXTURE_2D_ARRAY, so that all of them
+* can be sampled without rebinding textures. Materials are placed on the pages with shelf packing,
+* every material is then addressed by its layer and a UV rectangle within the layer.
+* Shaders map texture coordinates into the rectangle as uvRect.xy + fract(uv) * uvRect.zw,
+* border texels are replicated into padding around each rectangle, so filtering does not bleed.
+* Pages have a short mip chain, which is generated from the first level. Rectangles with their padding
+* start at multiples of 2^(NUM_LEVELS - 1) texels and the padding is as wide, so even the smallest level
+* never mixes texels of two materials.
+*/
+class MaterialAtlas
+{
+public:
+	static const int PAGE_SIZE; //!< Width and height of one array layer in texels (2048)
+	static const int NUM_LEVELS; //!< Mip levels of every page (5)
+	static const int PADDING; //!< Texels of replicated border around every material, 2^(NUM_LEVELS - 1) (16)
+
+	/** \brief Placement of one material within the atlas. */
+	struct Material
+	{
+		std::string path; //!< Source image of the material
+		int width; //!< Width of the image in texels
+		int height; //!< Height of the image in texels
+		int layer; //!< Array layer, that contains the material
+		int x; //!< Left texel of the image within the layer (without padding)
+		int y; //!< Bottom texel of the image within the layer (without padding)
+		glm::vec4 uvRect; //!< Offset (xy) and scale (zw) mapping texture coordinates into the layer
+	};
+
+	MaterialAtlas() = default;
+	MaterialAtlas(const MaterialAtlas&) = delete;
+	MaterialAtlas& operator=(const MaterialAtlas&) = delete;
+	~MaterialAtlas();
+
+	/** \brief  Adds material from image file. Only size of the image is read here, pixels are loaded by build().
+	*   \return Index of the material, valid after the atlas is built.
+	*/
+	int addMaterial(const std::string& path);
+
+	/** \brief  Packs materials, creates the texture array and requests the images from given loader. Must be called on the OpenGL thread. */
+	void build(TextureLoader& textureLoader);
+
+	/** \brief  Gets OpenGL name of the texture array. */
+	GLuint getTexture() const;
+
+	/** \brief  Gets number of array layers (pages). */
+	int getNumLayers() const;
+
+	/** \brief  Gets material placement. Placement is known after the atlas is built. */
+	const Material& getMaterial(int materialIndex) const;
+
+	/** \brief  Gets number of materials. */
+	int getNumMaterials() const;
+
+	/** \brief  Deletes texture array from the GPU. */
+	void deleteAtlas();
+
+private:
+	std::vector<Material> _materials; // Materials in order of adding
+	GLuint _texture = 0; // Texture array with all materials
+	int _numLayers = 0; // Number of array layers
+	bool _isBuilt = false; // Flag telling, if atlas has been built already
+
+	void pack();
+};
+
+#endif
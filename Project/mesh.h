@@ -7,6 +7,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "shader.h"
+#include "glStateCache.h"
+#include "boundingVolumes.h"
 
 #include <string>
 #include <vector>
@@ -38,6 +40,9 @@ public:
 	vector<unsigned int> indices;
 	vector<Texture>      textures;
 	unsigned int VAO;
+	// bounding volumes in local space, used for culling
+	BoundingBox          bounds;
+	BoundingSphere       boundingSphere;
 
 	// constructor
 	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
@@ -46,6 +51,13 @@ public:
 		this->indices = indices;
 		this->textures = textures;
 
+		// compute bounding volumes once, vertices do not change afterwards
+		if (!this->vertices.empty())
+		{
+			bounds = BoundingBox::fromPoints(&this->vertices[0].Position, this->vertices.size(), sizeof(Vertex));
+			boundingSphere = BoundingSphere::fromPoints(&this->vertices[0].Position, this->vertices.size(), sizeof(Vertex));
+		}
+
 		// now that we have all the required data, set the vertex buffers and its attribute pointers.
 		setupMesh();
 	}
@@ -60,7 +72,7 @@ public:
 		unsigned int heightNr = 1;
 		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
+			GLStateCache::getInstance().activeTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
 			// retrieve texture number (the N in diffuse_textureN)
 			string number;
 			string name = textures[i].type;
@@ -74,18 +86,18 @@ public:
 				number = std::to_string(heightNr++); // transfer unsigned int to stream
 
 			// now set the sampler to the correct texture unit
-			glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
+			shader.setInt(name + number, i);
 			// and finally bind the texture
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+			GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textures[i].id);
 		}
 
 		// draw mesh
-		glBindVertexArray(VAO);
+		GLStateCache::getInstance().bindVertexArray(VAO);
 		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+		GLStateCache::getInstance().bindVertexArray(0);
 
 		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		GLStateCache::getInstance().activeTexture(GL_TEXTURE0);
 	}
 
 private:
@@ -100,15 +112,15 @@ private:
 		glGenBuffers(1, &VBO);
 		glGenBuffers(1, &EBO);
 
-		glBindVertexArray(VAO);
+		GLStateCache::getInstance().bindVertexArray(VAO);
 		// load data into vertex buffers
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		GLStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, VBO);
 		// A great thing about structs is that their memory layout is sequential for all its items.
 		// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
 		// again translates to 3/2 floats which translates to a byte array.
 		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		GLStateCache::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
 		// set the vertex attribute pointers
@@ -128,7 +140,7 @@ private:
 		glEnableVertexAttribArray(4);
 		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
 
-		glBindVertexArray(0);
+		GLStateCache::getInstance().bindVertexArray(0);
 	}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,371 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Project
+#include "meshOptimizer.h"
+
+namespace {
+
+	// Scoring constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+	const int MAX_PRECOMPUTED_VALENCE = 64;
+
+	// Score of vertex at given cache position (-1 if not cached) with given number of triangles still to be emitted
+	float getVertexScore(int cachePosition, uint32_t remainingValence)
+	{
+		if (remainingValence == 0) {
+			return -1.0f;
+		}
+
+		auto score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// Vertices of the last triangle get fixed score, so that the next triangle does not simply go back
+			if (cachePosition < 3) {
+				score = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const auto scaler = 1.0f / float(mesh_optimizer::VERTEX_CACHE_SIZE - 3);
+				score = std::pow(1.0f - float(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+
+		// Boost vertices with only few triangles left, so that they get finished and do not stay alone
+		return score + VALENCE_BOOST_SCALE * std::pow(float(remainingValence), -VALENCE_BOOST_POWER);
+	}
+
+	// Simulated FIFO cache : vertex is cached, if fewer than cacheSize misses happened since it was added.
+	// Advancing time by more than cacheSize empties the cache.
+	struct FifoCache
+	{
+		std::vector<uint32_t> timestamps;
+		uint32_t time;
+		uint32_t cacheSize;
+
+		FifoCache(size_t numVertices, uint32_t size)
+			: timestamps(numVertices, 0)
+			, time(size + 1)
+			, cacheSize(size) {}
+
+		// Returns 1 on a miss
+		uint32_t access(uint32_t vertex)
+		{
+			if (time - timestamps[vertex] <= cacheSize) {
+				return 0;
+			}
+			timestamps[vertex] = time++;
+			return 1;
+		}
+
+		void clear()
+		{
+			time += cacheSize + 1;
+		}
+	};
+
+	struct Cluster
+	{
+		size_t firstTriangle;
+		size_t numTriangles;
+		float sortKey;
+	};
+
+} // namespace
+
+namespace mesh_optimizer {
+
+	VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, size_t numIndices, size_t numVertices)
+	{
+		VertexCacheStatistics statistics;
+		FifoCache cache(numVertices, ANALYSIS_CACHE_SIZE);
+		std::vector<uint8_t> isReferenced(numVertices, 0);
+		size_t numReferencedVertices = 0;
+
+		for (size_t i = 0; i < numIndices; i++)
+		{
+			statistics.numTransformedVertices += cache.access(indices[i]);
+			numReferencedVertices += isReferenced[indices[i]] ? 0 : 1;
+			isReferenced[indices[i]] = 1;
+		}
+
+		if (numIndices >= 3) {
+			statistics.acmr = float(statistics.numTransformedVertices) / float(numIndices / 3);
+		}
+		if (numReferencedVertices > 0) {
+			statistics.atvr = float(statistics.numTransformedVertices) / float(numReferencedVertices);
+		}
+		return statistics;
+	}
+
+	void optimizeVertexCache(uint32_t* indices, size_t numIndices, size_t numVertices)
+	{
+		const auto numTriangles = numIndices / 3;
+		if (numTriangles == 0) {
+			return;
+		}
+
+		// Scores for small valences and all cache positions are looked up instead of computed
+		float valenceScores[MAX_PRECOMPUTED_VALENCE + 1];
+		float cacheScores[VERTEX_CACHE_SIZE][MAX_PRECOMPUTED_VALENCE + 1];
+		for (auto valence = 0; valence <= MAX_PRECOMPUTED_VALENCE; valence++)
+		{
+			valenceScores[valence] = getVertexScore(-1, valence);
+			for (auto position = 0; position < VERTEX_CACHE_SIZE; position++) {
+				cacheScores[position][valence] = getVertexScore(position, valence);
+			}
+		}
+
+		const auto scoreVertex = [&](int cachePosition, uint32_t remainingValence) {
+			if (remainingValence > MAX_PRECOMPUTED_VALENCE) {
+				return getVertexScore(cachePosition, remainingValence);
+			}
+			return cachePosition >= 0 ? cacheScores[cachePosition][remainingValence] : valenceScores[remainingValence];
+		};
+
+		// Triangles of every vertex, not yet emitted triangles are kept at the front of each vertex' range
+		std::vector<uint32_t> remainingValences(numVertices, 0);
+		for (size_t i = 0; i < numIndices; i++) {
+			remainingValences[indices[i]]++;
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+		for (size_t i = 0; i < numVertices; i++) {
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingValences[i];
+		}
+
+		std::vector<uint32_t> adjacency(numIndices);
+		std::vector<uint32_t> fillCounts(numVertices, 0);
+		for (size_t i = 0; i < numIndices; i++)
+		{
+			const auto vertex = indices[i];
+			adjacency[adjacencyOffsets[vertex] + fillCounts[vertex]++] = uint32_t(i / 3);
+		}
+
+		std::vector<float> vertexScores(numVertices);
+		for (size_t i = 0; i < numVertices; i++) {
+			vertexScores[i] = scoreVertex(-1, remainingValences[i]);
+		}
+
+		std::vector<float> triangleScores(numTriangles);
+		std::vector<uint8_t> isEmitted(numTriangles, 0);
+		auto bestTriangle = 0;
+		for (size_t i = 0; i < numTriangles; i++)
+		{
+			triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+			if (triangleScores[i] > triangleScores[bestTriangle]) {
+				bestTriangle = int(i);
+			}
+		}
+
+		std::vector<uint32_t> output(numIndices);
+		uint32_t cache[VERTEX_CACHE_SIZE + 3];
+		uint32_t newCache[VERTEX_CACHE_SIZE + 3];
+		size_t cacheSize = 0;
+		size_t nextCandidate = 0;
+
+		for (size_t emitted = 0; emitted < numTriangles; emitted++)
+		{
+			// Dead end, no cached vertex has triangles left, continue with next triangle in input order
+			if (bestTriangle < 0)
+			{
+				while (isEmitted[nextCandidate]) {
+					nextCandidate++;
+				}
+				bestTriangle = int(nextCandidate);
+			}
+
+			const auto* triangle = indices + size_t(bestTriangle) * 3;
+			output[emitted * 3] = triangle[0];
+			output[emitted * 3 + 1] = triangle[1];
+			output[emitted * 3 + 2] = triangle[2];
+			isEmitted[bestTriangle] = 1;
+
+			// Emitted triangle is removed from the remaining triangles of its vertices
+			for (auto corner = 0; corner < 3; corner++)
+			{
+				const auto vertex = triangle[corner];
+				auto* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				const auto remaining = remainingValences[vertex];
+				for (uint32_t i = 0; i < remaining; i++)
+				{
+					if (vertexTriangles[i] == uint32_t(bestTriangle))
+					{
+						std::swap(vertexTriangles[i], vertexTriangles[remaining - 1]);
+						break;
+					}
+				}
+				remainingValences[vertex]--;
+			}
+
+			// Vertices of the triangle move to the front of the LRU cache, the rest keeps its order
+			size_t newCacheSize = 0;
+			for (auto corner = 0; corner < 3; corner++) {
+				newCache[newCacheSize++] = triangle[corner];
+			}
+			for (size_t i = 0; i < cacheSize; i++)
+			{
+				const auto vertex = cache[i];
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+					newCache[newCacheSize++] = vertex;
+				}
+			}
+
+			// Rescore all vertices, whose position changed (including the ones pushed out), and their triangles
+			for (size_t i = 0; i < newCacheSize; i++)
+			{
+				const auto vertex = newCache[i];
+				const auto position = i < size_t(VERTEX_CACHE_SIZE) ? int(i) : -1;
+
+				const auto score = scoreVertex(position, remainingValences[vertex]);
+				const auto scoreDelta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const auto* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t j = 0; j < remainingValences[vertex]; j++) {
+					triangleScores[vertexTriangles[j]] += scoreDelta;
+				}
+			}
+
+			cacheSize = std::min(newCacheSize, size_t(VERTEX_CACHE_SIZE));
+			std::copy(newCache, newCache + cacheSize, cache);
+
+			// Next triangle is the best one using a cached vertex
+			bestTriangle = -1;
+			auto bestScore = -1.0f;
+			for (size_t i = 0; i < cacheSize; i++)
+			{
+				const auto vertex = cache[i];
+				const auto* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t j = 0; j < remainingValences[vertex]; j++)
+				{
+					if (triangleScores[vertexTriangles[j]] > bestScore)
+					{
+						bestScore = triangleScores[vertexTriangles[j]];
+						bestTriangle = int(vertexTriangles[j]);
+					}
+				}
+			}
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void optimizeOverdraw(uint32_t* indices, size_t numIndices, const glm::vec3* positions, size_t numVertices, float threshold)
+	{
+		const auto numTriangles = numIndices / 3;
+		if (numTriangles == 0) {
+			return;
+		}
+
+		// Hard boundaries are triangles, where the cache order starts over (all three vertices miss)
+		std::vector<size_t> hardBoundaries;
+		FifoCache cache(numVertices, ANALYSIS_CACHE_SIZE);
+		for (size_t i = 0; i < numTriangles; i++)
+		{
+			const auto misses = cache.access(indices[i * 3]) + cache.access(indices[i * 3 + 1]) + cache.access(indices[i * 3 + 2]);
+			if (misses == 3) {
+				hardBoundaries.push_back(i);
+			}
+		}
+		hardBoundaries.push_back(numTriangles);
+
+		// Hard clusters are split further, wherever the part from a cold cache is not much worse than the whole cluster
+		std::vector<Cluster> clusters;
+		for (size_t hard = 0; hard + 1 < hardBoundaries.size(); hard++)
+		{
+			const auto first = hardBoundaries[hard];
+			const auto last = hardBoundaries[hard + 1];
+
+			cache.clear();
+			uint32_t clusterMisses = 0;
+			for (auto i = first * 3; i < last * 3; i++) {
+				clusterMisses += cache.access(indices[i]);
+			}
+			const auto clusterAcmr = float(clusterMisses) / float(last - first);
+
+			cache.clear();
+			auto clusterStart = first;
+			uint32_t misses = 0;
+			for (auto i = first; i < last; i++)
+			{
+				misses += cache.access(indices[i * 3]) + cache.access(indices[i * 3 + 1]) + cache.access(indices[i * 3 + 2]);
+				if (float(misses) / float(i + 1 - clusterStart) <= clusterAcmr * threshold || i + 1 == last)
+				{
+					clusters.push_back({ clusterStart, i + 1 - clusterStart, 0.0f });
+					clusterStart = i + 1;
+					misses = 0;
+					cache.clear();
+				}
+			}
+		}
+
+		// Area weighted centroid of the mesh
+		glm::vec3 meshCentroid(0.0f);
+		auto meshArea = 0.0f;
+		for (size_t i = 0; i < numTriangles; i++)
+		{
+			const auto& p0 = positions[indices[i * 3]];
+			const auto& p1 = positions[indices[i * 3 + 1]];
+			const auto& p2 = positions[indices[i * 3 + 2]];
+			const auto area = glm::length(glm::cross(p1 - p0, p2 - p0));
+			meshCentroid += (p0 + p1 + p2) * (area / 3.0f);
+			meshArea += area;
+		}
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : positions[indices[0]];
+
+		// Clusters facing away from the mesh center are in front of the rest from most view directions
+		for (auto& cluster : clusters)
+		{
+			glm::vec3 centroid(0.0f), normal(0.0f);
+			auto clusterArea = 0.0f;
+			for (auto i = cluster.firstTriangle; i < cluster.firstTriangle + cluster.numTriangles; i++)
+			{
+				const auto& p0 = positions[indices[i * 3]];
+				const auto& p1 = positions[indices[i * 3 + 1]];
+				const auto& p2 = positions[indices[i * 3 + 2]];
+				const auto areaNormal = glm::cross(p1 - p0, p2 - p0);
+				const auto area = glm::length(areaNormal);
+				centroid += (p0 + p1 + p2) * (area / 3.0f);
+				normal += areaNormal;
+				clusterArea += area;
+			}
+
+			const auto normalLength = glm::length(normal);
+			if (clusterArea > 0.0f && normalLength > 0.0f) {
+				cluster.sortKey = glm::dot(centroid / clusterArea - meshCentroid, normal / normalLength);
+			}
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+			return a.sortKey > b.sortKey;
+		});
+
+		std::vector<uint32_t> output;
+		output.reserve(numTriangles * 3);
+		for (const auto& cluster : clusters) {
+			output.insert(output.end(), indices + cluster.firstTriangle * 3, indices + (cluster.firstTriangle + cluster.numTriangles) * 3);
+		}
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	std::vector<int> optimizeVertexFetch(uint32_t* indices, size_t numIndices, size_t numVertices, size_t& numUsedVertices)
+	{
+		std::vector<int> remap(numVertices, -1);
+		numUsedVertices = 0;
+		for (size_t i = 0; i < numIndices; i++)
+		{
+			auto& newIndex = remap[indices[i]];
+			if (newIndex < 0) {
+				newIndex = int(numUsedVertices++);
+			}
+			indices[i] = uint32_t(newIndex);
+		}
+		return remap;
+	}
+
+} // namespace mesh_optimizer
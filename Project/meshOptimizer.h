@@ -0,0 +1,63 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+/**
+  Reordering of indexed triangle lists for faster rendering. Triangles are ordered for the post-transform
+  vertex cache (Forsyth's linear-speed vertex cache optimisation), clusters of the ordered triangles can
+  be sorted so that outward facing ones come first (overdraw ordering after Sander et al.), and vertices
+  are then renumbered in the order the triangles fetch them. For opaque meshes none of them changes the rendered image.
+*/
+namespace mesh_optimizer {
+
+	const int VERTEX_CACHE_SIZE = 32; //!< Size of the LRU cache modelled when scoring vertices
+	const int ANALYSIS_CACHE_SIZE = 16; //!< Size of the FIFO cache simulated by analyzeVertexCache
+
+	/** \brief Post-transform vertex cache efficiency of a triangle list. */
+	struct VertexCacheStatistics
+	{
+		uint32_t numTransformedVertices = 0; //!< Cache misses, i.e. vertex shader invocations
+		float acmr = 0.0f; //!< Average cache miss ratio, transformed vertices per triangle (0.5 at best, 3 at worst)
+		float atvr = 0.0f; //!< Average transformed vertex ratio, transformed vertices per referenced vertex (1 at best)
+	};
+
+	/** \brief  Simulates FIFO post-transform cache of ANALYSIS_CACHE_SIZE entries over the triangle list. */
+	VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, size_t numIndices, size_t numVertices);
+
+	/** \brief  Reorders triangles in place to maximize vertex cache hits. */
+	void optimizeVertexCache(uint32_t* indices, size_t numIndices, size_t numVertices);
+
+	/** \brief  Reorders clusters of cache optimized triangles in place, so that triangles likely to occlude others are drawn first.
+	*   \param  threshold Allowed growth of the cache miss ratio caused by splitting the triangles into more clusters (e.g. 1.05)
+	*/
+	void optimizeOverdraw(uint32_t* indices, size_t numIndices, const glm::vec3* positions, size_t numVertices, float threshold);
+
+	/** \brief  Renumbers vertices in order of their first use, indices are updated in place.
+	*   \return Remap table, new index of every old vertex (-1 for unreferenced vertices, which are dropped).
+	*/
+	std::vector<int> optimizeVertexFetch(uint32_t* indices, size_t numIndices, size_t numVertices, size_t& numUsedVertices);
+
+	/** \brief  Applies remap table from optimizeVertexFetch to a vertex attribute stream. */
+	template <typename T>
+	std::vector<T> remapVertices(const std::vector<T>& vertices, const std::vector<int>& remap, size_t numUsedVertices)
+	{
+		std::vector<T> result(numUsedVertices);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			if (remap[i] >= 0) {
+				result[remap[i]] = vertices[i];
+			}
+		}
+		return result;
+	}
+
+} // namespace mesh_optimizer
+
+#endif
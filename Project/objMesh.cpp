@@ -0,0 +1,135 @@
+// STL
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "glStateCache.h"
+#include "objMesh.h"
+
+namespace static_meshes_3D {
+
+	ObjMesh::ObjMesh(const std::string& filePath, bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+		: StaticMeshIndexed3D(withPositions, withTextureCoordinates, withNormals, vertexLayout)
+		, _filePath(filePath)
+	{
+		initializeData();
+	}
+
+	bool ObjMesh::isLoaded() const
+	{
+		return _isInitialized;
+	}
+
+	const std::string& ObjMesh::getFilePath() const
+	{
+		return _filePath;
+	}
+
+	int ObjMesh::getNumVertices() const
+	{
+		return _numVertices;
+	}
+
+	int ObjMesh::getNumIndices() const
+	{
+		return _numIndices;
+	}
+
+	const std::vector<CookedMesh::Submesh>& ObjMesh::getSubmeshes() const
+	{
+		return _submeshes;
+	}
+
+	void ObjMesh::initializeData()
+	{
+		if (_isInitialized) {
+			return;
+		}
+
+		// Parsing and welding happen only when the cache is missing or stale
+		CookedMesh cookedMesh;
+		if (!cookedMesh.loadOrCook(_filePath)) {
+			return;
+		}
+
+		_numVertices = static_cast<int>(cookedMesh.getNumVertices());
+		_numIndices = static_cast<int>(cookedMesh.getNumIndices());
+		_indexType = cookedMesh.getIndexType();
+		_indexSize = cookedMesh.getIndexSize();
+		_submeshes = cookedMesh.getSubmeshes();
+
+		// Generate VAO and VBOs for vertex attributes and indices
+		glGenVertexArrays(1, &_vao);
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		_vbo.createVBO();
+		_indicesVBO.createVBO();
+
+		if (_vertexLayout == VertexLayout::Planar && hasPositions() && hasTextureCoordinates() && hasNormals())
+		{
+			// Cache streams already are the planar vertex buffer
+			cookedMesh.uploadVertices(_vbo);
+			_boundingSphere = BoundingSphere::fromPoints(cookedMesh.getPositions(), _numVertices, sizeof(glm::vec3));
+		}
+		else
+		{
+			// Other layouts and attribute subsets are assembled in memory first
+			const std::vector<glm::vec3> positions(cookedMesh.getPositions(), cookedMesh.getPositions() + _numVertices);
+			const std::vector<glm::vec2> textureCoordinates(cookedMesh.getTextureCoordinates(), cookedMesh.getTextureCoordinates() + _numVertices);
+			const std::vector<glm::vec3> normals(cookedMesh.getNormals(), cookedMesh.getNormals() + _numVertices);
+			addVertexData(positions, textureCoordinates, normals);
+			_vbo.bindVBO();
+			_vbo.uploadDataToGPU(GL_STATIC_DRAW);
+		}
+		_bounds = cookedMesh.getBounds();
+		setVertexAttributesPointers(_numVertices);
+
+		cookedMesh.uploadIndices(_indicesVBO);
+
+		_isInitialized = true;
+	}
+
+	void ObjMesh::render() const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glDrawElements(GL_TRIANGLES, _numIndices, _indexType, 0);
+	}
+
+	void ObjMesh::renderSubmesh(size_t submesh) const
+	{
+		if (!_isInitialized || submesh >= _submeshes.size()) {
+			return;
+		}
+
+		const auto& range = _submeshes[submesh];
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glDrawElements(GL_TRIANGLES, range.numIndices, _indexType, reinterpret_cast<void*>(range.firstIndex * _indexSize));
+	}
+
+	void ObjMesh::renderInstanced(int numInstances) const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glDrawElementsInstanced(GL_TRIANGLES, _numIndices, _indexType, 0, numInstances);
+	}
+
+	void ObjMesh::renderPoints() const
+	{
+		if (!_isInitialized) {
+			return;
+		}
+
+		// Every welded vertex once
+		GLStateCache::getInstance().bindVertexArray(_vao);
+		glDrawArrays(GL_POINTS, 0, _numVertices);
+	}
+
+} // namespace static_meshes_3D
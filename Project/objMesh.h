@@ -0,0 +1,70 @@
+#ifndef OBJ_MESH_H
+#define OBJ_MESH_H
+
+// STL
+#include <string>
+#include <vector>
+
+#include "common/staticMeshIndexed3D.h"
+#include "cookedMesh.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Static mesh loaded from a Wavefront OBJ file. The triangle soup from the loader is welded
+	* into unique vertices, so the mesh is rendered with indexed triangles, using 16 bit indices
+	* whenever they can address all vertices. The welded mesh is cooked into a binary cache next
+	* to the OBJ file (see CookedMesh), later loads upload it straight from the mapped cache.
+	*/
+	class ObjMesh : public StaticMeshIndexed3D
+	{
+	public:
+		ObjMesh(const std::string& filePath,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar);
+
+		void render() const override;
+		void renderPoints() const override;
+		void renderInstanced(int numInstances) const override;
+
+		/**
+		 * Renders only triangles of given submesh.
+		 */
+		void renderSubmesh(size_t submesh) const;
+
+		/**
+		 * Checks, if the file was loaded and the mesh is ready to be rendered.
+		 */
+		bool isLoaded() const;
+
+		/**
+		 * Gets path of the loaded OBJ file.
+		 */
+		const std::string& getFilePath() const;
+
+		/**
+		 * Gets number of unique vertices after welding.
+		 */
+		int getNumVertices() const;
+
+		/**
+		 * Gets number of indices, three per triangle.
+		 */
+		int getNumIndices() const;
+
+		/**
+		 * Gets submeshes (index ranges by material) of the mesh.
+		 */
+		const std::vector<CookedMesh::Submesh>& getSubmeshes() const;
+
+	private:
+		std::string _filePath; // Path of the OBJ file
+		GLenum _indexType = GL_UNSIGNED_INT; // Type of indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		size_t _indexSize = sizeof(GLuint); // Size of one index in bytes
+		std::vector<CookedMesh::Submesh> _submeshes; // Index ranges by material
+
+		void initializeData() override;
+	};
+
+} // namespace static_meshes_3D
+#endif
@@ -0,0 +1,202 @@
+// STL
+#include <chrono>
+#include <cstring>
+
+// Project
+#include "glStateCache.h"
+#include "pixelUploadRing.h"
+
+namespace {
+
+	const size_t UPLOAD_ALIGNMENT = 16; // Alignment of upload offsets within the ring
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+} // namespace
+
+PixelUploadRing::PixelUploadRing(size_t capacityBytes)
+	: _capacityBytes(capacityBytes)
+{
+}
+
+PixelUploadRing::~PixelUploadRing()
+{
+	deleteRing();
+}
+
+void PixelUploadRing::createRing()
+{
+	if (_isCreated) {
+		return;
+	}
+
+	auto& glState = GLStateCache::getInstance();
+	glGenBuffers(1, &_bufferID);
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, _bufferID);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, _capacityBytes, nullptr, GL_STREAM_DRAW);
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	_head = 0;
+	_isCreated = true;
+}
+
+void PixelUploadRing::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels, size_t numBytes)
+{
+	upload(pixels, numBytes, [=](const void* source) {
+		glTexImage2D(target, level, internalFormat, width, height, 0, format, type, source);
+	});
+}
+
+void PixelUploadRing::texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint layer, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels, size_t numBytes)
+{
+	upload(pixels, numBytes, [=](const void* source) {
+		glTexSubImage3D(target, level, x, y, layer, width, height, 1, format, type, source);
+	});
+}
+
+void PixelUploadRing::compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+	const void* data, size_t numBytes)
+{
+	upload(data, numBytes, [=](const void* source) {
+		glCompressedTexImage2D(target, level, internalFormat, width, height, 0, GLsizei(numBytes), source);
+	});
+}
+
+const std::vector<PixelUploadRing::UploadTiming>& PixelUploadRing::getUploadTimings() const
+{
+	return _uploadTimings;
+}
+
+void PixelUploadRing::clearUploadTimings()
+{
+	_uploadTimings.clear();
+}
+
+void PixelUploadRing::deleteRing()
+{
+	if (!_isCreated) {
+		return;
+	}
+
+	for (const auto& range : _inFlight) {
+		glDeleteSync(range.fence);
+	}
+	_inFlight.clear();
+
+	GLStateCache::getInstance().onBufferDeleted(_bufferID);
+	glDeleteBuffers(1, &_bufferID);
+	_bufferID = 0;
+	_isCreated = false;
+}
+
+void PixelUploadRing::upload(const void* pixels, size_t numBytes, const std::function<void(const void*)>& submit)
+{
+	createRing();
+
+	auto& glState = GLStateCache::getInstance();
+	UploadTiming timing{ numBytes, numBytes <= _capacityBytes, 0.0, 0.0, 0.0 };
+
+	const auto submitFromClientMemory = [&]() {
+		const auto submitStart = std::chrono::steady_clock::now();
+		glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		submit(pixels);
+		timing.isStreamed = false;
+		timing.submitMilliseconds = millisecondsSince(submitStart);
+		_uploadTimings.push_back(timing);
+	};
+
+	if (!timing.isStreamed)
+	{
+		submitFromClientMemory();
+		return;
+	}
+
+	retireFinished();
+
+	// Uploads are never split, ring wraps to the start, when the rest of it is too small
+	auto begin = (_head + UPLOAD_ALIGNMENT - 1) / UPLOAD_ALIGNMENT * UPLOAD_ALIGNMENT;
+	if (begin + numBytes > _capacityBytes) {
+		begin = 0;
+	}
+	const auto end = begin + numBytes;
+
+	const auto waitStart = std::chrono::steady_clock::now();
+	waitForRange(begin, end);
+	timing.waitMilliseconds = millisecondsSince(waitStart);
+
+	// Range is not used by the GPU anymore, so mapping it does not need to synchronize
+	const auto copyStart = std::chrono::steady_clock::now();
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, _bufferID);
+	auto ringMemory = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, begin, numBytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (ringMemory != nullptr) {
+		memcpy(ringMemory, pixels, numBytes);
+	}
+
+	// Unmapping fails, if the buffer contents got lost while mapped (e.g. on a display mode change)
+	const auto isCopied = ringMemory != nullptr && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+	timing.copyMilliseconds = millisecondsSince(copyStart);
+	if (!isCopied)
+	{
+		// Range was not used, ring stays as it was
+		submitFromClientMemory();
+		return;
+	}
+
+	// With unpack buffer bound, pixel pointer is an offset into it
+	const auto submitStart = std::chrono::steady_clock::now();
+	submit(reinterpret_cast<const void*>(begin));
+	timing.submitMilliseconds = millisecondsSince(submitStart);
+
+	// Other uploads read from client memory, so unpack buffer must not stay bound
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	_inFlight.push_back({ begin, end, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+	_head = end;
+	_uploadTimings.push_back(timing);
+}
+
+void PixelUploadRing::retireFinished()
+{
+	while (!_inFlight.empty())
+	{
+		const auto status = glClientWaitSync(_inFlight.front().fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			break;
+		}
+
+		glDeleteSync(_inFlight.front().fence);
+		_inFlight.pop_front();
+	}
+}
+
+void PixelUploadRing::waitForRange(size_t begin, size_t end)
+{
+	const auto overlapsAny = [this, begin, end]() {
+		for (const auto& range : _inFlight)
+		{
+			if (range.begin < end && begin < range.end) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Ranges are retired oldest first, the oldest ones are those right after the head
+	while (overlapsAny())
+	{
+		const auto fence = _inFlight.front().fence;
+		GLenum status;
+		do {
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (status == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(fence);
+		_inFlight.pop_front();
+	}
+}
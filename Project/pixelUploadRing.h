@@ -0,0 +1,81 @@
+#ifndef PIXEL_UPLOAD_RING_H
+#define PIXEL_UPLOAD_RING_H
+
+// STL
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+* Streams texture uploads through a ring of GL_PIXEL_UNPACK_BUFFER memory. Pixels are copied
+* into the ring and the texture is filled from it, so glTexImage2D returns without copying
+* client memory, the driver transfers it asynchronously. Every upload is guarded by a fence,
+* ring memory is written again only after the GPU has finished reading it.
+* Uploads larger than the whole ring, or whose ring range cannot be mapped, fall back to plain glTexImage2D from client memory.
+*/
+class PixelUploadRing
+{
+public:
+	/** \brief Timing of one upload, all times in milliseconds of CPU time on the OpenGL thread. */
+	struct UploadTiming
+	{
+		size_t numBytes; //!< Size of the pixel data
+		bool isStreamed; //!< False, if upload did not fit into the ring or mapping it failed, and fell back to client memory
+		double waitMilliseconds; //!< Time spent waiting for fences of earlier uploads
+		double copyMilliseconds; //!< Time spent copying pixels into the ring
+		double submitMilliseconds; //!< Time spent in the glTexImage2D call
+	};
+
+	PixelUploadRing(size_t capacityBytes);
+	~PixelUploadRing();
+
+	/** \brief Creates ring buffer on the GPU. Must be called on the OpenGL thread. */
+	void createRing();
+
+	/** \brief  Uploads level of currently bound 2D texture through the ring, same as glTexImage2D. Creates ring on first use.
+	*   \param  numBytes  Size of the pixel data
+	*/
+	void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+		GLenum format, GLenum type, const void* pixels, size_t numBytes);
+
+	/** \brief  Uploads region of layer of currently bound texture array through the ring, same as glTexSubImage3D. Creates ring on first use. */
+	void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint layer, GLsizei width, GLsizei height,
+		GLenum format, GLenum type, const void* pixels, size_t numBytes);
+
+	/** \brief  Uploads compressed level of currently bound 2D texture through the ring, same as glCompressedTexImage2D. Creates ring on first use. */
+	void compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+		const void* data, size_t numBytes);
+
+	/** \brief Gets timings of all uploads since the last clear. */
+	const std::vector<UploadTiming>& getUploadTimings() const;
+
+	/** \brief Forgets all recorded upload timings. */
+	void clearUploadTimings();
+
+	/** \brief Deletes ring buffer and pending fences from the GPU. */
+	void deleteRing();
+
+private:
+	// Part of the ring, that is still being read by the GPU
+	struct InFlightRange
+	{
+		size_t begin;
+		size_t end;
+		GLsync fence;
+	};
+
+	size_t _capacityBytes; // Size of the whole ring
+	GLuint _bufferID = 0; // Pixel unpack buffer of the ring
+	size_t _head = 0; // Offset, where the next upload starts
+	std::deque<InFlightRange> _inFlight; // Ranges in order of uploading
+	std::vector<UploadTiming> _uploadTimings; // Recorded upload timings
+	bool _isCreated = false; // Flag telling, if ring has been created on the GPU
+
+	void upload(const void* pixels, size_t numBytes, const std::function<void(const void*)>& submit);
+	void retireFinished();
+	void waitForRange(size_t begin, size_t end);
+};
+
+#endif
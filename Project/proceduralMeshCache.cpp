@@ -0,0 +1,62 @@
+// STL
+#include <tuple>
+
+// Project
+#include "proceduralMeshCache.h"
+
+namespace static_meshes_3D {
+
+	bool ProceduralMeshCache::CylinderKey::operator<(const CylinderKey& other) const
+	{
+		return std::tie(radius, numSlices, height, attributeFlags)
+			< std::tie(other.radius, other.numSlices, other.height, other.attributeFlags);
+	}
+
+	int ProceduralMeshCache::getAttributeFlags(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+	{
+		return (withPositions ? 1 : 0) | (withTextureCoordinates ? 2 : 0) | (withNormals ? 4 : 0)
+			| (vertexLayout == VertexLayout::Interleaved ? 8 : 0);
+	}
+
+	std::shared_ptr<const Cylinder> ProceduralMeshCache::getCylinder(float radius, int numSlices, float height,
+		bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+	{
+		const CylinderKey key{ radius, numSlices, height, getAttributeFlags(withPositions, withTextureCoordinates, withNormals, vertexLayout) };
+
+		const auto it = _cylinders.find(key);
+		if (it != _cylinders.end()) {
+			return it->second;
+		}
+
+		auto cylinder = std::make_shared<const Cylinder>(radius, numSlices, height, withPositions, withTextureCoordinates, withNormals, vertexLayout);
+		_cylinders.emplace(key, cylinder);
+		return cylinder;
+	}
+
+	std::shared_ptr<const IndexedCylinder> ProceduralMeshCache::getIndexedCylinder(float radius, int numSlices, float height,
+		bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+	{
+		const CylinderKey key{ radius, numSlices, height, getAttributeFlags(withPositions, withTextureCoordinates, withNormals, vertexLayout) };
+
+		const auto it = _indexedCylinders.find(key);
+		if (it != _indexedCylinders.end()) {
+			return it->second;
+		}
+
+		auto cylinder = std::make_shared<const IndexedCylinder>(radius, numSlices, height, withPositions, withTextureCoordinates, withNormals, vertexLayout);
+		_indexedCylinders.emplace(key, cylinder);
+		return cylinder;
+	}
+
+	size_t ProceduralMeshCache::size() const
+	{
+		return _cylinders.size() + _indexedCylinders.size();
+	}
+
+	void ProceduralMeshCache::clear()
+	{
+		_cylinders.clear();
+		_indexedCylinders.clear();
+	}
+
+} // namespace static_meshes_3D
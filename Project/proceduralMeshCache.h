@@ -0,0 +1,63 @@
+#ifndef PROCEDURAL_MESH_CACHE_H
+#define PROCEDURAL_MESH_CACHE_H
+
+// STL
+#include <map>
+#include <memory>
+
+// Project
+#include "cylinder.h"
+#include "indexedCylinder.h"
+
+namespace static_meshes_3D {
+
+	/**
+	* Caches procedurally generated static meshes, so that every distinct mesh is generated
+	* and uploaded to the GPU only once. Meshes are handed out as shared immutable handles.
+	*/
+	class ProceduralMeshCache
+	{
+	public:
+		/**
+		 * Gets cylinder with given parameters, generating it on the first request.
+		 */
+		std::shared_ptr<const Cylinder> getCylinder(float radius, int numSlices, float height,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar);
+
+		/**
+		 * Gets indexed cylinder with given parameters, generating it on the first request.
+		 */
+		std::shared_ptr<const IndexedCylinder> getIndexedCylinder(float radius, int numSlices, float height,
+			bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true,
+			VertexLayout vertexLayout = VertexLayout::Planar);
+
+		/**
+		 * Gets number of distinct meshes held by the cache.
+		 */
+		size_t size() const;
+
+		/**
+		 * Releases all cached meshes. Must be called while the OpenGL context is still alive.
+		 */
+		void clear();
+
+	private:
+		struct CylinderKey
+		{
+			float radius;
+			int numSlices;
+			float height;
+			int attributeFlags;
+
+			bool operator<(const CylinderKey& other) const;
+		};
+
+		std::map<CylinderKey, std::shared_ptr<const Cylinder>> _cylinders; // Generated cylinders by their parameters
+		std::map<CylinderKey, std::shared_ptr<const IndexedCylinder>> _indexedCylinders; // Generated indexed cylinders by their parameters
+
+		static int getAttributeFlags(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout);
+	};
+
+} // namespace static_meshes_3D
+#endif
@@ -0,0 +1,115 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "glStateCache.h"
+#include "renderQueue.h"
+
+namespace {
+	// Bit widths of sort key fields, from the most significant one
+	const int PROGRAM_BITS = 12;
+	const int TEXTURE_BITS = 16;
+	const int VAO_BITS = 16;
+	const int DEPTH_BITS = 20;
+}
+
+void RenderQueue::begin(const glm::vec3& cameraPosition, float farPlane)
+{
+	_items.clear();
+	_sortEntries.clear();
+	_cameraPosition = cameraPosition;
+	_farPlane = farPlane;
+}
+
+void RenderQueue::submit(const Shader& shader, GLuint texture, const static_meshes_3D::StaticMesh3D& mesh, const glm::mat4& model)
+{
+	RenderItem item;
+	item.shader = &shader;
+	item.texture = texture;
+	item.mesh = &mesh;
+	item.model = model;
+	addItem(item, mesh.getVAO());
+}
+
+void RenderQueue::submit(const Shader& shader, GLuint texture, const static_meshes_3D::GeometryArena& arena,
+	const static_meshes_3D::GeometryRange& range, const glm::mat4& model)
+{
+	RenderItem item;
+	item.shader = &shader;
+	item.texture = texture;
+	item.arena = &arena;
+	item.range = range;
+	item.model = model;
+	addItem(item, range.vao);
+}
+
+void RenderQueue::flush()
+{
+	std::sort(_sortEntries.begin(), _sortEntries.end(), [](const SortEntry& a, const SortEntry& b) {
+		return a.key < b.key;
+	});
+
+	auto& glState = GLStateCache::getInstance();
+	for (const auto& entry : _sortEntries)
+	{
+		const auto& item = _items[entry.itemIndex];
+
+		// State cache skips everything, that did not change since the previous item
+		item.shader->use();
+		glState.activeTexture(GL_TEXTURE0);
+		glState.bindTexture(GL_TEXTURE_2D, item.texture);
+		item.shader->setMat4(getModelUniform(*item.shader), item.model);
+
+		if (item.mesh != nullptr) {
+			item.mesh->render();
+		}
+		else {
+			item.arena->render(item.range);
+		}
+	}
+
+	_items.clear();
+	_sortEntries.clear();
+}
+
+size_t RenderQueue::getNumItems() const
+{
+	return _items.size();
+}
+
+void RenderQueue::addItem(const RenderItem& item, GLuint vao)
+{
+	SortEntry entry;
+	entry.key = makeSortKey(item.shader->ID, item.texture, vao, item.model);
+	entry.itemIndex = uint32_t(_items.size());
+
+	_items.push_back(item);
+	_sortEntries.push_back(entry);
+}
+
+uint64_t RenderQueue::makeSortKey(GLuint program, GLuint texture, GLuint vao, const glm::mat4& model) const
+{
+	// Depth of the object origin, quantized to the depth bits, so that nearer objects come first
+	const auto distance = glm::length(glm::vec3(model[3]) - _cameraPosition);
+	const auto normalizedDepth = std::min(std::max(distance / _farPlane, 0.0f), 1.0f);
+	const auto maxDepth = (uint64_t(1) << DEPTH_BITS) - 1;
+	const auto depth = uint64_t(normalizedDepth * float(maxDepth));
+
+	uint64_t key = uint64_t(program) & ((uint64_t(1) << PROGRAM_BITS) - 1);
+	key = (key << TEXTURE_BITS) | (uint64_t(texture) & ((uint64_t(1) << TEXTURE_BITS) - 1));
+	key = (key << VAO_BITS) | (uint64_t(vao) & ((uint64_t(1) << VAO_BITS) - 1));
+	key = (key << DEPTH_BITS) | depth;
+	return key;
+}
+
+UniformHandle RenderQueue::getModelUniform(const Shader& shader)
+{
+	const auto it = _modelUniforms.find(shader.ID);
+	if (it != _modelUniforms.end()) {
+		return it->second;
+	}
+
+	const auto handle = shader.getUniformHandle("model");
+	_modelUniforms.emplace(shader.ID, handle);
+	return handle;
+}
@@ -0,0 +1,71 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// STL
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "shader.h"
+#include "common/staticMesh3D.h"
+#include "geometryArena.h"
+
+/**
+  Collects draw items during scene traversal and submits them sorted by a 64-bit key
+  (program -> texture -> VAO -> depth), so that state changes are minimized and opaque
+  objects with the same state are drawn front to back.
+*/
+class RenderQueue
+{
+public:
+	/** \brief Starts new frame, dropping all items of the previous one.
+	*   \param cameraPosition Camera position used to compute depth of the items
+	*   \param farPlane       Distance of the far plane, depth is quantized within it
+	*/
+	void begin(const glm::vec3& cameraPosition, float farPlane);
+
+	/** \brief Adds static mesh draw. Texture is bound to texture unit 0. */
+	void submit(const Shader& shader, GLuint texture, const static_meshes_3D::StaticMesh3D& mesh, const glm::mat4& model);
+
+	/** \brief Adds draw of a geometry arena range. Texture is bound to texture unit 0. */
+	void submit(const Shader& shader, GLuint texture, const static_meshes_3D::GeometryArena& arena,
+		const static_meshes_3D::GeometryRange& range, const glm::mat4& model);
+
+	/** \brief Sorts collected items and renders them in order. */
+	void flush();
+
+	/** \brief Gets number of items collected in the current frame. */
+	size_t getNumItems() const;
+
+private:
+	struct RenderItem
+	{
+		const Shader* shader = nullptr;
+		GLuint texture = 0;
+		const static_meshes_3D::StaticMesh3D* mesh = nullptr; // Either mesh...
+		const static_meshes_3D::GeometryArena* arena = nullptr; // ...or arena with range is rendered
+		static_meshes_3D::GeometryRange range;
+		glm::mat4 model;
+	};
+
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t itemIndex;
+	};
+
+	std::vector<RenderItem> _items; // Items collected in the current frame
+	std::vector<SortEntry> _sortEntries; // Sort keys of the items
+	std::unordered_map<GLuint, UniformHandle> _modelUniforms; // Model matrix uniform of every program seen so far
+	glm::vec3 _cameraPosition = glm::vec3(0.0f);
+	float _farPlane = 100.0f;
+
+	void addItem(const RenderItem& item, GLuint vao);
+	uint64_t makeSortKey(GLuint program, GLuint texture, GLuint vao, const glm::mat4& model) const;
+	UniformHandle getModelUniform(const Shader& shader);
+};
+#endif
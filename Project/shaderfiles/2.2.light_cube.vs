@@ -2,8 +2,14 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform FrameUniforms
+{
+	mat4 projection;
+	mat4 view;
+	vec4 cameraPosition;
+	float time;
+};
 
 void main()
 {
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+
+layout (std140) uniform FrameUniforms
+{
+	mat4 projection;
+	mat4 view;
+	vec4 cameraPosition;
+	float time;
+};
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+}
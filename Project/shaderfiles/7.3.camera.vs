@@ -5,8 +5,14 @@ layout (location = 1) in vec2 aTexCoord;
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform FrameUniforms
+{
+	mat4 projection;
+	mat4 view;
+	vec4 cameraPosition;
+	float time;
+};
 
 void main()
 {
@@ -0,0 +1,18 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in vec4 UvRect;
+flat in float Layer;
+
+// all materials, packed into layers of one array
+uniform sampler2DArray atlas;
+
+void main()
+{
+	// material repeats within its rectangle of the layer, the mip level is chosen from the unwrapped
+	// coordinates, otherwise the jump of fract() selects the smallest level along every seam
+	vec2 uv = UvRect.xy + fract(TexCoord) * UvRect.zw;
+	vec2 unwrapped = TexCoord * UvRect.zw;
+	FragColor = textureGrad(atlas, vec3(uv, Layer), dFdx(unwrapped), dFdy(unwrapped));
+}
@@ -0,0 +1,38 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 8) in uint aDrawId;
+
+out vec2 TexCoord;
+flat out vec4 UvRect;
+flat out float Layer;
+
+layout (std140) uniform FrameUniforms
+{
+	mat4 projection;
+	mat4 view;
+	vec4 cameraPosition;
+	float time;
+};
+
+// model matrix and material atlas placement of one draw
+struct DrawData
+{
+	mat4 model;
+	vec4 uvRect;
+	float layer;
+};
+
+// data of all draws, indexed by draw ID
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData draws[];
+};
+
+void main()
+{
+	gl_Position = projection * view * draws[aDrawId].model * vec4(aPos, 1.0f);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	UvRect = draws[aDrawId].uvRect;
+	Layer = draws[aDrawId].layer;
+}
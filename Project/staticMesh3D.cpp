@@ -2,6 +2,7 @@
 
 // Project
 #include "common/staticMesh3D.h"
+#include "glStateCache.h"
 #include <glm/glm.hpp>
 
 
@@ -11,10 +12,11 @@ const int StaticMesh3D::POSITION_ATTRIBUTE_INDEX           = 0;
 const int StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX = 1;
 const int StaticMesh3D::NORMAL_ATTRIBUTE_INDEX             = 2;
 
-StaticMesh3D::StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals)
+StaticMesh3D::StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
     : _hasPositions(withPositions)
     , _hasTextureCoordinates(withTextureCoordinates)
-    , _hasNormals(withNormals) {}
+    , _hasNormals(withNormals)
+    , _vertexLayout(vertexLayout) {}
 
 StaticMesh3D::~StaticMesh3D()
 {
@@ -27,6 +29,7 @@ void StaticMesh3D::deleteMesh()
         return;
     }
 
+    GLStateCache::getInstance().onVertexArrayDeleted(_vao);
     glDeleteVertexArrays(1, &_vao);
     _vbo.deleteVBO();
 
@@ -48,6 +51,11 @@ bool StaticMesh3D::hasNormals() const
     return _hasNormals;
 }
 
+VertexLayout StaticMesh3D::getVertexLayout() const
+{
+    return _vertexLayout;
+}
+
 int StaticMesh3D::getVertexByteSize() const
 {
     int result = 0;
@@ -64,31 +72,91 @@ int StaticMesh3D::getVertexByteSize() const
     return result;
 }
 
+GLuint StaticMesh3D::getVAO() const
+{
+    return _vao;
+}
+
+const BoundingBox& StaticMesh3D::getBounds() const
+{
+    return _bounds;
+}
+
+const BoundingSphere& StaticMesh3D::getBoundingSphere() const
+{
+    return _boundingSphere;
+}
+
+void StaticMesh3D::addVertexData(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& textureCoordinates, const std::vector<glm::vec3>& normals)
+{
+    if (hasPositions())
+    {
+        _bounds = BoundingBox::fromPoints(positions.data(), positions.size(), sizeof(glm::vec3));
+        _boundingSphere = BoundingSphere::fromPoints(positions.data(), positions.size(), sizeof(glm::vec3));
+    }
+
+    if (_vertexLayout == VertexLayout::Planar)
+    {
+        // Whole attribute blocks one after another
+        if (hasPositions()) {
+            _vbo.addRawData(positions.data(), sizeof(glm::vec3) * positions.size());
+        }
+        if (hasTextureCoordinates()) {
+            _vbo.addRawData(textureCoordinates.data(), sizeof(glm::vec2) * textureCoordinates.size());
+        }
+        if (hasNormals()) {
+            _vbo.addRawData(normals.data(), sizeof(glm::vec3) * normals.size());
+        }
+        return;
+    }
+
+    // Interleaved layout - all attributes of one vertex are stored together
+    const auto numVertices = hasPositions() ? positions.size() : hasTextureCoordinates() ? textureCoordinates.size() : normals.size();
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        if (hasPositions()) {
+            _vbo.addData(positions[i]);
+        }
+        if (hasTextureCoordinates()) {
+            _vbo.addData(textureCoordinates[i]);
+        }
+        if (hasNormals()) {
+            _vbo.addData(normals[i]);
+        }
+    }
+}
+
 void StaticMesh3D::setVertexAttributesPointers(int numVertices)
 {
+    // In planar layout, every attribute is tightly packed in its own block and offset skips whole blocks,
+    // in interleaved layout all attributes share one stride and offset moves within a single vertex
+    const auto isInterleaved = _vertexLayout == VertexLayout::Interleaved;
+    const auto vertexStride = isInterleaved ? getVertexByteSize() : 0;
+    const auto blockVertices = isInterleaved ? 1 : numVertices;
+
     uint64_t offset = 0;
     if (hasPositions())
     {
         glEnableVertexAttribArray(POSITION_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+        glVertexAttribPointer(POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, isInterleaved ? vertexStride : sizeof(glm::vec3), reinterpret_cast<void*>(offset));
 
-        offset += sizeof(glm::vec3)*numVertices;
+        offset += sizeof(glm::vec3)*blockVertices;
     }
 
     if (hasTextureCoordinates())
     {
         glEnableVertexAttribArray(TEXTURE_COORDINATE_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset));
+        glVertexAttribPointer(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE, isInterleaved ? vertexStride : sizeof(glm::vec2), reinterpret_cast<void*>(offset));
 
-        offset += sizeof(glm::vec2)*numVertices;
+        offset += sizeof(glm::vec2)*blockVertices;
     }
 
     if (hasNormals())
     {
         glEnableVertexAttribArray(NORMAL_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(NORMAL_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+        glVertexAttribPointer(NORMAL_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, isInterleaved ? vertexStride : sizeof(glm::vec3), reinterpret_cast<void*>(offset));
 
-        offset += sizeof(glm::vec3)*numVertices;
+        offset += sizeof(glm::vec3)*blockVertices;
     }
 }
 
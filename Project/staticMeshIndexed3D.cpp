@@ -3,8 +3,8 @@
 
 namespace static_meshes_3D {
 
-StaticMeshIndexed3D::StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals)
-    : StaticMesh3D(withPositions, withTextureCoordinates, withNormals) {}
+StaticMeshIndexed3D::StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals, VertexLayout vertexLayout)
+    : StaticMesh3D(withPositions, withTextureCoordinates, withNormals, vertexLayout) {}
 
 StaticMeshIndexed3D::~StaticMeshIndexed3D()
 {
@@ -0,0 +1,299 @@
+// STL
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+// Project
+#include "glStateCache.h"
+#include "textureLoader.h"
+
+const size_t TextureLoader::DEFAULT_UPLOAD_RING_BYTES = 16 * 1024 * 1024;
+
+TextureLoader::TextureLoader(int numWorkers, size_t uploadRingBytes)
+	: _uploadRing(uploadRingBytes)
+{
+	if (numWorkers <= 0) {
+		numWorkers = std::max(1, int(std::thread::hardware_concurrency()));
+	}
+
+	for (int i = 0; i < numWorkers; i++) {
+		_workers.emplace_back(&TextureLoader::workerLoop, this);
+	}
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_isStopping = true;
+	}
+	_jobsCondition.notify_all();
+
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+
+	// Images, that were decoded but never uploaded
+	auto image = _decodedHead.exchange(nullptr, std::memory_order_acquire);
+	while (image != nullptr)
+	{
+		auto next = image->next;
+		delete image;
+		image = next;
+	}
+}
+
+GLuint TextureLoader::requestTexture(const std::string& path, bool flipVertically)
+{
+	static const unsigned char placeholderPixel[4] = { 128, 128, 128, 255 };
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+
+	//Sets the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	//Sets the texture filtering parameters, mip mapped minification is enabled once the mip chain is uploaded
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixel);
+	_textures.push_back(texture);
+
+	pushJob({ path, texture, flipVertically, false, 0, 0, 0, 0, 0, 0 });
+	return texture;
+}
+
+void TextureLoader::requestAtlasRegion(const std::string& path, GLuint arrayTexture, int layer, int x, int y, int width, int height,
+	int padding, bool flipVertically)
+{
+	pushJob({ path, arrayTexture, flipVertically, true, layer, x, y, width, height, padding });
+}
+
+int TextureLoader::pump()
+{
+	// Take the whole stack at once, producers keep pushing onto a fresh empty one
+	auto image = _decodedHead.exchange(nullptr, std::memory_order_acquire);
+
+	// Stack is in reverse order of completion, reverse it to upload in order of completion
+	DecodedImage* ordered = nullptr;
+	while (image != nullptr)
+	{
+		auto next = image->next;
+		image->next = ordered;
+		ordered = image;
+		image = next;
+	}
+
+	int numUploaded = 0;
+	std::vector<GLuint> updatedArrays;
+	while (ordered != nullptr)
+	{
+		const auto& job = ordered->job;
+		if (job.isAtlasRegion && !ordered->regionPixels.empty() && std::find(updatedArrays.begin(), updatedArrays.end(), job.texture) == updatedArrays.end()) {
+			updatedArrays.push_back(job.texture);
+		}
+
+		auto next = ordered->next;
+		uploadImage(*ordered);
+		delete ordered;
+		ordered = next;
+
+		_numPending--;
+		numUploaded++;
+	}
+
+	// Mip levels of arrays are generated once for all regions, that arrived together
+	for (const auto arrayTexture : updatedArrays)
+	{
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, arrayTexture);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+
+	return numUploaded;
+}
+
+int TextureLoader::getNumPending() const
+{
+	return _numPending;
+}
+
+const PixelUploadRing& TextureLoader::getUploadRing() const
+{
+	return _uploadRing;
+}
+
+void TextureLoader::deleteTextures()
+{
+	auto& glState = GLStateCache::getInstance();
+	for (const auto texture : _textures) {
+		glState.onTextureDeleted(texture);
+	}
+
+	if (!_textures.empty()) {
+		glDeleteTextures(GLsizei(_textures.size()), _textures.data());
+	}
+	_textures.clear();
+	_uploadRing.deleteRing();
+}
+
+void TextureLoader::pushJob(DecodeJob job)
+{
+	_numPending++;
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_jobs.push_back(std::move(job));
+	}
+	_jobsCondition.notify_one();
+}
+
+void TextureLoader::workerLoop()
+{
+	while (true)
+	{
+		DecodeJob job;
+		{
+			std::unique_lock<std::mutex> lock(_jobsMutex);
+			_jobsCondition.wait(lock, [this]() { return _isStopping || !_jobs.empty(); });
+			if (_isStopping) {
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		auto image = new DecodedImage;
+		image->job = std::move(job);
+		if (isDDSPath(image->job.path))
+		{
+			// Atlas holds only RGBA8 texels, block compressed images cannot be copied into it
+			if (image->job.isAtlasRegion || !loadDDSImage(*image))
+			{
+				std::cout << "Failure to load texture " << image->job.path << std::endl;
+				image->ddsFile.reset();
+			}
+		}
+		else
+		{
+			image->cookedTexture.reset(new CookedTexture);
+			if (!image->cookedTexture->loadOrCook(image->job.path, image->job.flipVertically)
+				|| (image->job.isAtlasRegion && !makeRegionPixels(*image)))
+			{
+				std::cout << "Failure to load texture " << image->job.path << std::endl;
+				image->cookedTexture.reset();
+			}
+		}
+
+		pushDecoded(image);
+	}
+}
+
+void TextureLoader::pushDecoded(DecodedImage* image)
+{
+	image->next = _decodedHead.load(std::memory_order_relaxed);
+	while (!_decodedHead.compare_exchange_weak(image->next, image, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+void TextureLoader::uploadImage(const DecodedImage& image)
+{
+	// Failed textures keep their placeholder
+	if (!image.cookedTexture && !image.ddsFile && image.regionPixels.empty()) {
+		return;
+	}
+
+	// Small mip levels and atlas regions have rows, whose width in bytes is not multiple of 4
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const auto& job = image.job;
+	if (job.isAtlasRegion)
+	{
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, job.texture);
+		_uploadRing.texSubImage3D(GL_TEXTURE_2D_ARRAY, 0, job.x - job.padding, job.y - job.padding, job.layer,
+			job.width + 2 * job.padding, job.height + 2 * job.padding, GL_RGBA, GL_UNSIGNED_BYTE,
+			image.regionPixels.data(), image.regionPixels.size());
+	}
+	else if (image.ddsFile)
+	{
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, job.texture);
+		const auto& ddsImage = image.ddsImage;
+		for (unsigned int level = 0; level < ddsImage.mipMapCount; level++)
+		{
+			unsigned int width, height;
+			size_t numBytes;
+			const auto data = getDDSLevel(ddsImage, 0, level, &width, &height, &numBytes);
+			_uploadRing.compressedTexImage2D(GL_TEXTURE_2D, GLint(level), ddsImage.format, GLsizei(width), GLsizei(height), data, numBytes);
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(ddsImage.mipMapCount) - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ddsImage.mipMapCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	}
+	else
+	{
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, job.texture);
+		image.cookedTexture->upload(_uploadRing);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool TextureLoader::isDDSPath(const std::string& path)
+{
+	static const char extension[] = ".dds";
+	const auto extensionLength = sizeof(extension) - 1;
+	if (path.size() < extensionLength) {
+		return false;
+	}
+
+	return std::equal(extension, extension + extensionLength, path.end() - extensionLength,
+		[](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+}
+
+bool TextureLoader::loadDDSImage(DecodedImage& image)
+{
+	image.ddsFile.reset(new MappedFile);
+	if (!image.ddsFile->open(image.job.path) || !parseDDS(image.job.path.c_str(), image.ddsFile->getData(), image.ddsFile->getSize(), image.ddsImage)) {
+		return false;
+	}
+
+	// Texture has been created as GL_TEXTURE_2D, array files need loadDDS
+	if (image.ddsImage.arraySize != 1)
+	{
+		std::cout << image.job.path << " is a texture array, only single layer .dds files can be requested" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TextureLoader::makeRegionPixels(DecodedImage& image)
+{
+	// Atlas holds only the base level in RGBA8 and the region has been reserved for exact image size
+	const auto& job = image.job;
+	const auto& base = image.cookedTexture->getLevels().front();
+	if (image.cookedTexture->getFormat() != CookedTexture::Format::RGBA8 || base.width != job.width || base.height != job.height) {
+		return false;
+	}
+
+	// Border texels are repeated into the padding, so filtering at the region edges does not pick up neighbours
+	const auto paddedWidth = job.width + 2 * job.padding;
+	const auto paddedHeight = job.height + 2 * job.padding;
+	image.regionPixels.resize(size_t(paddedWidth) * paddedHeight * 4);
+	for (int y = 0; y < paddedHeight; y++)
+	{
+		const auto sourceY = std::min(std::max(y - job.padding, 0), job.height - 1);
+		for (int x = 0; x < paddedWidth; x++)
+		{
+			const auto sourceX = std::min(std::max(x - job.padding, 0), job.width - 1);
+			memcpy(&image.regionPixels[(size_t(y) * paddedWidth + x) * 4], base.data + (size_t(sourceY) * job.width + sourceX) * 4, 4);
+		}
+	}
+
+	// Region is complete, mapped cache file is not needed anymore
+	image.cookedTexture.reset();
+	return true;
+}
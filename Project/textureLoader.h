@@ -0,0 +1,113 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+// STL
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Project
+#include "common/texture.hpp"
+#include "cookedTexture.h"
+#include "mappedFile.h"
+#include "pixelUploadRing.h"
+
+/**
+* Loads 2D textures asynchronously. Textures are loaded from their caches (or cooked, when the cache is stale)
+* in parallel on a pool of worker threads, finished textures are handed back through a lock-free queue
+* and uploaded on the OpenGL thread.
+* Every requested texture gets its OpenGL name immediately, holding a 1x1 placeholder until the real image is uploaded,
+* so the name can be used for rendering right away and stays the same after the upload.
+* Block compressed .dds files are not cooked, they are mapped and validated on the workers and their levels are uploaded as they are.
+* Pixels are streamed to the textures through a pixel unpack buffer ring.
+*/
+class TextureLoader
+{
+public:
+	static const size_t DEFAULT_UPLOAD_RING_BYTES; //!< Default size of the upload ring (16 MiB)
+
+	/** \brief  Starts worker threads. 0 means one worker per hardware thread. */
+	TextureLoader(int numWorkers = 0, size_t uploadRingBytes = DEFAULT_UPLOAD_RING_BYTES);
+	~TextureLoader();
+
+	/** \brief  Creates texture with placeholder contents and queues its image for decoding. Must be called on the OpenGL thread.
+	*   .dds files must hold a single 2D layer and are never flipped, block compressed images are stored in the orientation they are sampled with.
+	*   \return OpenGL name of the texture.
+	*/
+	GLuint requestTexture(const std::string& path, bool flipVertically = true);
+
+	/** \brief  Queues image for decoding into rectangle of texture array layer, e.g. of a material atlas. Must be called on the OpenGL thread.
+	*   The rectangle is written to the first level, mip levels of the array are generated again once the region has been uploaded.
+	*   \param  padding  Number of texels around the rectangle, that are filled with replicated border of the image
+	*/
+	void requestAtlasRegion(const std::string& path, GLuint arrayTexture, int layer, int x, int y, int width, int height,
+		int padding, bool flipVertically = true);
+
+	/** \brief  Uploads all images decoded since the last call. Must be called on the OpenGL thread, usually once per frame.
+	*   \return Number of textures uploaded.
+	*/
+	int pump();
+
+	/** \brief  Gets number of requested textures, that have not been uploaded yet. */
+	int getNumPending() const;
+
+	/** \brief  Gets ring used for uploads, e.g. to inspect upload timings. */
+	const PixelUploadRing& getUploadRing() const;
+
+	/** \brief  Deletes all textures created by the loader and the upload ring. Must be called while the OpenGL context is still alive. */
+	void deleteTextures();
+
+private:
+	struct DecodeJob
+	{
+		std::string path;
+		GLuint texture;
+		bool flipVertically;
+		bool isAtlasRegion; // Image goes into rectangle of texture array layer instead of a whole 2D texture
+		int layer;
+		int x;
+		int y;
+		int width;
+		int height;
+		int padding;
+	};
+
+	// Result of loading, linked into the lock-free result stack
+	struct DecodedImage
+	{
+		DecodeJob job;
+		std::unique_ptr<CookedTexture> cookedTexture; // Loaded texture, null for atlas regions, .dds files and failed textures
+		std::unique_ptr<MappedFile> ddsFile; // Mapped .dds file, null for other images
+		DDSImage ddsImage; // Levels of the .dds file, pointing into its mapping
+		std::vector<unsigned char> regionPixels; // Padded RGBA8 pixels of atlas region, empty if it could not be loaded
+		DecodedImage* next;
+	};
+
+	std::vector<std::thread> _workers; // Threads decoding images
+	std::deque<DecodeJob> _jobs; // Images waiting for a worker
+	std::mutex _jobsMutex; // Guards job queue
+	std::condition_variable _jobsCondition; // Wakes workers when jobs arrive or loader stops
+	bool _isStopping = false; // Flag telling workers to quit, guarded by job mutex
+
+	std::atomic<DecodedImage*> _decodedHead{ nullptr }; // Top of the lock-free stack of decoded images (multiple producers, one consumer)
+	std::vector<GLuint> _textures; // All textures created by the loader
+	int _numPending = 0; // Number of textures waiting for upload, touched only by the OpenGL thread
+	PixelUploadRing _uploadRing; // Streams pixels of decoded images to the GPU
+
+	void pushJob(DecodeJob job);
+	void workerLoop();
+	static bool isDDSPath(const std::string& path);
+	static bool loadDDSImage(DecodedImage& image);
+	static bool makeRegionPixels(DecodedImage& image);
+	void pushDecoded(DecodedImage* image);
+	void uploadImage(const DecodedImage& image);
+};
+
+#endif
@@ -0,0 +1,445 @@
+// STL
+#include <algorithm>
+#include <cstring>
+
+// Project
+#include "frustum.h"
+#include "transformSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SYSTEM_SSE2
+#include <emmintrin.h>
+#endif
+
+int TransformSystem::createTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	_positionX.push_back(position.x);
+	_positionY.push_back(position.y);
+	_positionZ.push_back(position.z);
+	_rotationX.push_back(rotation.x);
+	_rotationY.push_back(rotation.y);
+	_rotationZ.push_back(rotation.z);
+	_rotationW.push_back(rotation.w);
+	_scaleX.push_back(scale.x);
+	_scaleY.push_back(scale.y);
+	_scaleZ.push_back(scale.z);
+	_parents.push_back(-1);
+	_children.emplace_back();
+	_depths.push_back(0);
+	_worldMatrices.push_back(glm::mat4(1.0f));
+	_boundsSlots.push_back(-1);
+	_isDirty.push_back(0);
+	_outputSlots.push_back({ -1, 0 });
+	_isOutputPending.push_back(0);
+
+	const auto transform = int(_worldMatrices.size()) - 1;
+	markDirty(transform);
+	return transform;
+}
+
+bool TransformSystem::setParent(int transform, int parent)
+{
+	// Parent must not lie within subtree of the transform, that would create a cycle
+	for (auto ancestor = parent; ancestor >= 0; ancestor = _parents[ancestor])
+	{
+		if (ancestor == transform) {
+			return false;
+		}
+	}
+
+	const auto oldParent = _parents[transform];
+	if (oldParent == parent) {
+		return true;
+	}
+
+	if (oldParent >= 0)
+	{
+		auto& siblings = _children[oldParent];
+		siblings.erase(std::find(siblings.begin(), siblings.end(), transform));
+	}
+	if (parent >= 0) {
+		_children[parent].push_back(transform);
+	}
+
+	_parents[transform] = parent;
+	updateDepths(transform);
+	markDirty(transform);
+	return true;
+}
+
+int TransformSystem::getParent(int transform) const
+{
+	return _parents[transform];
+}
+
+int TransformSystem::getNumTransforms() const
+{
+	return int(_worldMatrices.size());
+}
+
+void TransformSystem::setPosition(int transform, const glm::vec3& position)
+{
+	if (_positionX[transform] == position.x && _positionY[transform] == position.y && _positionZ[transform] == position.z) {
+		return;
+	}
+
+	_positionX[transform] = position.x;
+	_positionY[transform] = position.y;
+	_positionZ[transform] = position.z;
+	markDirty(transform);
+}
+
+void TransformSystem::setRotation(int transform, const glm::quat& rotation)
+{
+	if (_rotationX[transform] == rotation.x && _rotationY[transform] == rotation.y
+		&& _rotationZ[transform] == rotation.z && _rotationW[transform] == rotation.w) {
+		return;
+	}
+
+	_rotationX[transform] = rotation.x;
+	_rotationY[transform] = rotation.y;
+	_rotationZ[transform] = rotation.z;
+	_rotationW[transform] = rotation.w;
+	markDirty(transform);
+}
+
+void TransformSystem::setScale(int transform, const glm::vec3& scale)
+{
+	if (_scaleX[transform] == scale.x && _scaleY[transform] == scale.y && _scaleZ[transform] == scale.z) {
+		return;
+	}
+
+	_scaleX[transform] = scale.x;
+	_scaleY[transform] = scale.y;
+	_scaleZ[transform] = scale.z;
+	markDirty(transform);
+}
+
+glm::vec3 TransformSystem::getPosition(int transform) const
+{
+	return glm::vec3(_positionX[transform], _positionY[transform], _positionZ[transform]);
+}
+
+glm::quat TransformSystem::getRotation(int transform) const
+{
+	return glm::quat(_rotationW[transform], _rotationX[transform], _rotationY[transform], _rotationZ[transform]);
+}
+
+glm::vec3 TransformSystem::getScale(int transform) const
+{
+	return glm::vec3(_scaleX[transform], _scaleY[transform], _scaleZ[transform]);
+}
+
+const glm::mat4& TransformSystem::getWorldMatrix(int transform) const
+{
+	return _worldMatrices[transform];
+}
+
+void TransformSystem::setLocalBounds(int transform, const BoundingBox& bounds)
+{
+	auto slot = _boundsSlots[transform];
+	if (slot < 0)
+	{
+		slot = int(_boundedTransforms.size());
+		_boundsSlots[transform] = slot;
+		_boundedTransforms.push_back(transform);
+		_localBounds.emplace_back();
+		_worldBounds.emplace_back();
+		_isHierarchyStale = true;
+	}
+
+	_localBounds[slot] = bounds;
+	if (_isDirty[transform]) {
+		return;
+	}
+
+	// World matrix is up to date, only the bounds need to follow
+	updateWorldBounds(transform);
+}
+
+BoundingBox TransformSystem::getWorldBounds(int transform) const
+{
+	const auto slot = _boundsSlots[transform];
+	return slot >= 0 ? _worldBounds[slot] : BoundingBox();
+}
+
+int TransformSystem::cull(Frustum& frustum, std::vector<uint8_t>& isVisible)
+{
+	updateHierarchy();
+
+	isVisible.assign(_worldMatrices.size(), 1);
+	for (const auto transform : _boundedTransforms) {
+		isVisible[transform] = 0;
+	}
+
+	const auto numVisible = _hierarchy.queryFrustum(frustum, _querySlots);
+	for (const auto slot : _querySlots) {
+		isVisible[_boundedTransforms[slot]] = 1;
+	}
+	return numVisible;
+}
+
+int TransformSystem::pick(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* distance)
+{
+	updateHierarchy();
+
+	const auto hit = _hierarchy.raycast(origin, direction, maxDistance);
+	if (distance != nullptr) {
+		*distance = hit.distance;
+	}
+	return hit.object >= 0 ? _boundedTransforms[hit.object] : -1;
+}
+
+int TransformSystem::queryOverlap(const BoundingBox& box, std::vector<int>& transforms)
+{
+	updateHierarchy();
+
+	transforms.clear();
+	_hierarchy.queryOverlap(box, _querySlots);
+	for (const auto slot : _querySlots) {
+		transforms.push_back(_boundedTransforms[slot]);
+	}
+	return int(transforms.size());
+}
+
+void TransformSystem::rebuildHierarchy()
+{
+	_isHierarchyStale = true;
+}
+
+int TransformSystem::createOutput()
+{
+	_pendingOutputTransforms.emplace_back();
+	return int(_pendingOutputTransforms.size()) - 1;
+}
+
+void TransformSystem::setOutput(int transform, int output, int slot)
+{
+	_outputSlots[transform] = { output, slot };
+
+	// Matrix must reach the new slot, even if the transform does not change anymore
+	markDirty(transform);
+}
+
+int TransformSystem::update()
+{
+	const auto numDirty = int(_dirtyTransforms.size());
+	if (numDirty == 0) {
+		return 0;
+	}
+
+	// Local matrices are computed in place of world matrices, then parents are applied top-down
+	sortDirtyTransformsByDepth();
+	computeLocalMatrices(_sortedDirtyTransforms.data(), numDirty);
+
+	for (const auto transform : _sortedDirtyTransforms)
+	{
+		const auto parent = _parents[transform];
+		if (parent >= 0) {
+			_worldMatrices[transform] = _worldMatrices[parent] * _worldMatrices[transform];
+		}
+
+		_isDirty[transform] = 0;
+		updateWorldBounds(transform);
+
+		const auto output = _outputSlots[transform].output;
+		if (output >= 0 && !_isOutputPending[transform])
+		{
+			_pendingOutputTransforms[output].push_back(transform);
+			_isOutputPending[transform] = 1;
+		}
+	}
+	_dirtyTransforms.clear();
+
+	return numDirty;
+}
+
+bool TransformSystem::isOutputDirty(int output) const
+{
+	return !_pendingOutputTransforms[output].empty();
+}
+
+void TransformSystem::writeOutput(int output, void* firstMatrix, size_t stride)
+{
+	auto& pending = _pendingOutputTransforms[output];
+	auto bytes = static_cast<unsigned char*>(firstMatrix);
+	for (const auto transform : pending)
+	{
+		memcpy(bytes + _outputSlots[transform].slot * stride, &_worldMatrices[transform], sizeof(glm::mat4));
+		_isOutputPending[transform] = 0;
+	}
+	pending.clear();
+}
+
+void TransformSystem::markDirty(int transform)
+{
+	// Descendants of a dirty transform are always dirty as well, so clean subtrees are the only ones to visit
+	if (_isDirty[transform]) {
+		return;
+	}
+
+	auto& stack = _traversalStack;
+	stack.assign(1, transform);
+	while (!stack.empty())
+	{
+		const auto current = stack.back();
+		stack.pop_back();
+		if (_isDirty[current]) {
+			continue;
+		}
+
+		_isDirty[current] = 1;
+		_dirtyTransforms.push_back(current);
+		stack.insert(stack.end(), _children[current].begin(), _children[current].end());
+	}
+}
+
+void TransformSystem::updateWorldBounds(int transform)
+{
+	const auto slot = _boundsSlots[transform];
+	if (slot < 0) {
+		return;
+	}
+
+	_worldBounds[slot] = _localBounds[slot].transformed(_worldMatrices[transform]);
+	if (!_isHierarchyStale) {
+		_hierarchy.updateObject(slot, _worldBounds[slot]);
+	}
+}
+
+void TransformSystem::updateHierarchy()
+{
+	if (_isHierarchyStale)
+	{
+		_hierarchy.build(_worldBounds);
+		_isHierarchyStale = false;
+		return;
+	}
+
+	_hierarchy.refit();
+}
+
+void TransformSystem::updateDepths(int transform)
+{
+	auto& stack = _traversalStack;
+	stack.assign(1, transform);
+	while (!stack.empty())
+	{
+		const auto current = stack.back();
+		stack.pop_back();
+
+		const auto parent = _parents[current];
+		_depths[current] = parent >= 0 ? _depths[parent] + 1 : 0;
+		stack.insert(stack.end(), _children[current].begin(), _children[current].end());
+	}
+}
+
+void TransformSystem::sortDirtyTransformsByDepth()
+{
+	// Counting sort, depth of scene graphs is small compared to number of transforms
+	_depthCounts.clear();
+	for (const auto transform : _dirtyTransforms)
+	{
+		const auto depth = size_t(_depths[transform]);
+		if (depth >= _depthCounts.size()) {
+			_depthCounts.resize(depth + 1, 0);
+		}
+		_depthCounts[depth]++;
+	}
+
+	auto offset = 0;
+	for (auto& count : _depthCounts)
+	{
+		const auto numAtDepth = count;
+		count = offset;
+		offset += numAtDepth;
+	}
+
+	_sortedDirtyTransforms.resize(_dirtyTransforms.size());
+	for (const auto transform : _dirtyTransforms) {
+		_sortedDirtyTransforms[_depthCounts[_depths[transform]]++] = transform;
+	}
+}
+
+void TransformSystem::computeLocalMatrices(const int* transforms, int count)
+{
+	// Local matrix is T * R * S, rotation part comes from the quaternion (same as glm::mat4_cast), columns scaled by scale
+	int i = 0;
+
+#ifdef TRANSFORM_SYSTEM_SSE2
+	const auto one = _mm_set1_ps(1.0f);
+	const auto two = _mm_set1_ps(2.0f);
+	const auto zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const auto* t = transforms + i;
+		const auto gather = [t](const std::vector<float>& component) {
+			return _mm_setr_ps(component[t[0]], component[t[1]], component[t[2]], component[t[3]]);
+		};
+
+		const auto qx = gather(_rotationX), qy = gather(_rotationY), qz = gather(_rotationZ), qw = gather(_rotationW);
+		const auto sx = gather(_scaleX), sy = gather(_scaleY), sz = gather(_scaleZ);
+
+		const auto xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		const auto xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		const auto wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		// Rows of this 4x4 block are matrix elements, lanes are the four transforms
+		auto c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		auto c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		auto c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		auto c0w = zero;
+
+		auto c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		auto c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		auto c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		auto c1w = zero;
+
+		auto c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		auto c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		auto c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		auto c2w = zero;
+
+		auto c3x = gather(_positionX);
+		auto c3y = gather(_positionY);
+		auto c3z = gather(_positionZ);
+		auto c3w = one;
+
+		// Transposing turns every block into one column of each of the four matrices
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+		_MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+
+		const __m128 columns[4][4] = {
+			{ c0x, c1x, c2x, c3x },
+			{ c0y, c1y, c2y, c3y },
+			{ c0z, c1z, c2z, c3z },
+			{ c0w, c1w, c2w, c3w }
+		};
+		for (int lane = 0; lane < 4; lane++)
+		{
+			auto matrix = reinterpret_cast<float*>(&_worldMatrices[t[lane]]);
+			for (int column = 0; column < 4; column++) {
+				_mm_storeu_ps(matrix + column * 4, columns[lane][column]);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const auto t = transforms[i];
+		const auto qx = _rotationX[t], qy = _rotationY[t], qz = _rotationZ[t], qw = _rotationW[t];
+		const auto xx = qx * qx, yy = qy * qy, zz = qz * qz;
+		const auto xy = qx * qy, xz = qx * qz, yz = qy * qz;
+		const auto wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+		auto& m = _worldMatrices[t];
+		m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * _scaleX[t], 2.0f * (xy + wz) * _scaleX[t], 2.0f * (xz - wy) * _scaleX[t], 0.0f);
+		m[1] = glm::vec4(2.0f * (xy - wz) * _scaleY[t], (1.0f - 2.0f * (xx + zz)) * _scaleY[t], 2.0f * (yz + wx) * _scaleY[t], 0.0f);
+		m[2] = glm::vec4(2.0f * (xz + wy) * _scaleZ[t], 2.0f * (yz - wx) * _scaleZ[t], (1.0f - 2.0f * (xx + yy)) * _scaleZ[t], 0.0f);
+		m[3] = glm::vec4(_positionX[t], _positionY[t], _positionZ[t], 1.0f);
+	}
+}
@@ -0,0 +1,161 @@
+#ifndef TRANSFORM_SYSTEM_H
+#define TRANSFORM_SYSTEM_H
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Project
+#include "boundingVolumeHierarchy.h"
+#include "boundingVolumes.h"
+
+class Frustum;
+
+/**
+  Stores position, rotation and scale of all scene objects in structure-of-arrays form
+  and keeps their world matrices cached. Transforms form a scene graph: every transform
+  can have a parent, its local matrix (translate * rotate * scale) is then relative to the parent.
+  Changing a transform marks it and its whole subtree dirty, only dirty transforms are
+  recomputed on update, local matrices four at a time and parents always before their children.
+
+  World matrices can be streamed into instance buffers: every transform can be assigned
+  to a slot of an output (e.g. per-draw data of a draw list), and only the matrices of
+  changed transforms are written to it. Transforms, that never change, cost nothing per frame.
+
+  Transforms with local bounds also keep world space bounding boxes, updated together with the
+  matrices. The boxes are indexed by a bounding volume hierarchy, which is refitted when they
+  change and serves culling, picking and overlap queries.
+*/
+class TransformSystem
+{
+public:
+	/** \brief  Creates transform with given position, rotation and scale.
+	*   \return Index of the transform.
+	*/
+	int createTransform(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+		const glm::vec3& scale = glm::vec3(1.0f));
+
+	/** \brief  Attaches transform to parent, -1 detaches it. Local values of the transform are kept,
+	*          so it moves together with the parent from now on.
+	*   \return False, if the parent is the transform itself or one of its descendants.
+	*/
+	bool setParent(int transform, int parent);
+
+	/** \brief Gets parent of transform, -1 if it has none. */
+	int getParent(int transform) const;
+
+	/** \brief Gets number of transforms. */
+	int getNumTransforms() const;
+
+	/** \brief Sets position of transform, marking it dirty, if it has changed. */
+	void setPosition(int transform, const glm::vec3& position);
+
+	/** \brief Sets rotation of transform, marking it dirty, if it has changed. */
+	void setRotation(int transform, const glm::quat& rotation);
+
+	/** \brief Sets scale of transform, marking it dirty, if it has changed. */
+	void setScale(int transform, const glm::vec3& scale);
+
+	glm::vec3 getPosition(int transform) const;
+	glm::quat getRotation(int transform) const;
+	glm::vec3 getScale(int transform) const;
+
+	/** \brief Gets cached world matrix of transform, valid after update. */
+	const glm::mat4& getWorldMatrix(int transform) const;
+
+	/** \brief Sets bounding box of the object in local space of transform, enabling its culling. */
+	void setLocalBounds(int transform, const BoundingBox& bounds);
+
+	/** \brief Gets world space bounding box of transform, valid after update. Empty, if transform has no local bounds. */
+	BoundingBox getWorldBounds(int transform) const;
+
+	/** \brief  Tests world bounds of all transforms against frustum. Transforms without bounds are always visible.
+	*   \param  isVisible Receives visibility flag of every transform
+	*   \return Number of visible transforms with bounds.
+	*/
+	int cull(Frustum& frustum, std::vector<uint8_t>& isVisible);
+
+	/** \brief  Finds transform with bounds nearest along ray, e.g. for picking with the mouse.
+	*   \param  distance Receives distance of the hit in multiples of direction length, if not null
+	*   \return Hit transform, -1 if ray does not hit any bounds within maximal distance.
+	*/
+	int pick(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* distance = nullptr);
+
+	/** \brief  Collects transforms, whose world bounds overlap given box.
+	*   \return Number of found transforms.
+	*/
+	int queryOverlap(const BoundingBox& box, std::vector<int>& transforms);
+
+	/** \brief  Rebuilds the hierarchy before next query. Refitting keeps tree topology, so after large movements
+	*          a rebuild restores query performance.
+	*/
+	void rebuildHierarchy();
+
+	/** \brief  Creates new output, to which world matrices can be written.
+	*   \return Identifier of the output.
+	*/
+	int createOutput();
+
+	/** \brief Assigns transform to slot of an output, its world matrix will be written there. */
+	void setOutput(int transform, int output, int slot);
+
+	/** \brief  Recomputes world matrices of all dirty transforms and their descendants.
+	*   \return Number of recomputed matrices.
+	*/
+	int update();
+
+	/** \brief Gets, if an output has matrices, that changed since they were last written. */
+	bool isOutputDirty(int output) const;
+
+	/** \brief Writes changed matrices of an output to buffer with given matrix stride, matrix of slot i goes to firstMatrix + i * stride. */
+	void writeOutput(int output, void* firstMatrix, size_t stride);
+
+private:
+	struct OutputSlot
+	{
+		int output; // Output, -1 if transform is not assigned to any
+		int slot; // Slot within the output
+	};
+
+	// Local transformation, one array per component
+	std::vector<float> _positionX, _positionY, _positionZ;
+	std::vector<float> _rotationX, _rotationY, _rotationZ, _rotationW;
+	std::vector<float> _scaleX, _scaleY, _scaleZ;
+
+	// Hierarchy
+	std::vector<int> _parents; // Parent of every transform, -1 for roots
+	std::vector<std::vector<int>> _children; // Children of every transform
+	std::vector<int> _depths; // Distance of every transform from its root
+
+	std::vector<glm::mat4> _worldMatrices; // Cached world matrices
+
+	// Bounds of transforms, that have them, slots are objects of the hierarchy
+	std::vector<int> _boundsSlots; // Bounds slot of every transform, -1 if it has no bounds
+	std::vector<int> _boundedTransforms; // Transform of every bounds slot
+	std::vector<BoundingBox> _localBounds; // Local bounds of every slot
+	std::vector<BoundingBox> _worldBounds; // World bounds of every slot
+	BoundingVolumeHierarchy _hierarchy; // Hierarchy over world bounds of all slots
+	bool _isHierarchyStale = true; // Flag telling, if hierarchy must be built again before next query
+	std::vector<int> _querySlots; // Results of hierarchy queries, reused between calls
+	std::vector<uint8_t> _isDirty; // Flags telling, if transform is in the dirty list
+	std::vector<int> _dirtyTransforms; // Transforms changed since the last update
+	std::vector<int> _sortedDirtyTransforms; // Dirty transforms ordered by depth, reused between updates
+	std::vector<int> _depthCounts; // Counting sort buckets, reused between updates
+	std::vector<int> _traversalStack; // Stack for walking subtrees, reused between calls
+	std::vector<OutputSlot> _outputSlots; // Output assignment of every transform
+	std::vector<std::vector<int>> _pendingOutputTransforms; // Transforms of every output, whose matrices were not written yet
+	std::vector<uint8_t> _isOutputPending; // Flags telling, if transform is in the pending list of its output
+
+	void markDirty(int transform);
+	void updateWorldBounds(int transform);
+	void updateHierarchy();
+	void updateDepths(int transform);
+	void sortDirtyTransformsByDepth();
+	void computeLocalMatrices(const int* transforms, int count);
+};
+
+#endif
@@ -4,6 +4,7 @@
 
 // Project
 #include "common/vertexBufferObject.h"
+#include "glStateCache.h"
 
 void VertexBufferObject::createVBO(size_t reserveSizeBytes)
 {
@@ -33,7 +34,7 @@ void VertexBufferObject::bindVBO(GLenum bufferType)
     }
 
     _bufferType = bufferType;
-    glBindBuffer(_bufferType, _bufferID);
+    GLStateCache::getInstance().bindBuffer(_bufferType, _bufferID);
 }
 
 //void VertexBufferObject::addRawData(const void* ptrData, uint32_t dataSizeBytes, int repeat)
@@ -83,6 +84,20 @@ void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
     _bytesAdded = 0;
 }
 
+void VertexBufferObject::uploadDataToGPU(GLenum usageHint, const void* ptrData, size_t dataSizeBytes)
+{
+    if (!_isBufferCreated)
+    {
+        std::cerr << "This buffer is not created yet! Call createVBO before uploading data to GPU!" << std::endl;
+        return;
+    }
+
+    glBufferData(_bufferType, dataSizeBytes, ptrData, usageHint);
+    _isDataUploaded = true;
+    _uploadedDataSize = dataSizeBytes;
+    _bytesAdded = 0;
+}
+
 void* VertexBufferObject::mapBufferToMemory(GLenum usageHint) const
 {
     if (!_isDataUploaded) {
@@ -113,21 +128,22 @@ GLuint VertexBufferObject::getBufferID() const
 
 void* VertexBufferObject::mapBufferToMemory(GLenum usageHint)
 {
-    return nullptr;
+    return static_cast<const VertexBufferObject*>(this)->mapBufferToMemory(usageHint);
 }
 
 void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, uint32_t offset, uint32_t length)
 {
-    return nullptr;
+    return static_cast<const VertexBufferObject*>(this)->mapSubBufferToMemory(usageHint, size_t(offset), size_t(length));
 }
 
 void VertexBufferObject::unmapBuffer()
 {
+    static_cast<const VertexBufferObject*>(this)->unmapBuffer();
 }
 
 GLuint VertexBufferObject::getBufferID()
 {
-    return GLuint();
+    return _bufferID;
 }
 
 size_t VertexBufferObject::getBufferSize()
@@ -142,6 +158,7 @@ void VertexBufferObject::deleteVBO()
     }
 
     //std::cout << "Deleting vertex buffer object with ID " << _bufferID << "..." << std::endl;
+    GLStateCache::getInstance().onBufferDeleted(_bufferID);
     glDeleteBuffers(1, &_bufferID);
     _isDataUploaded = false;
     _isBufferCreated = false;
@@ -0,0 +1,222 @@
+/**
+* Standalone check and benchmark of the SIMD kernels of linmath.h. The header is included twice into
+* separate namespaces, once with its SIMD kernels and once with LINMATH_NO_SIMD, so both versions run
+* in one program on the same inputs:
+* - every kernel has to produce bit identical results to the scalar code on NUM_CHECK_INPUTS random inputs,
+*   also when its output aliases an input,
+* - then both versions of every kernel are timed and reported in operations per second.
+*
+* Build from the repository root, floating point contraction must stay off as in the project build:
+*   g++ -O2 -ffp-contract=off tools/linmath_bench.cpp -o linmath_bench
+*   cl /O2 /fp:precise /EHsc tools\linmath_bench.cpp
+* Exit code is 1, if any kernel differs from the scalar code.
+*/
+
+// STL
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Intrinsics headers must be included outside of the namespaces below, their include guards keep linmath.h from including them again
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+#include "../Project/linmath.h"
+#if defined(LINMATH_SSE2)
+	const char* KERNELS = "SSE2";
+#elif defined(LINMATH_NEON)
+	const char* KERNELS = "NEON";
+#else
+	const char* KERNELS = "none (scalar fallback)";
+#endif
+}
+
+#undef LINMATH_H
+#undef LINMATH_H_FUNC
+#undef LINMATH_H_DEFINE_VEC
+#undef LINMATH_SSE2
+#undef LINMATH_NEON
+#undef quat_norm
+#define LINMATH_NO_SIMD
+
+namespace scalar {
+#include "../Project/linmath.h"
+}
+
+namespace {
+
+	const int NUM_CHECK_INPUTS = 1000000;
+	const int NUM_BENCH_INPUTS = 1024;
+	const int NUM_BENCH_ROUNDS = 20000;
+
+	// Random matrix or quaternion data, one operand is 16 floats
+	std::vector<float> makeInputs(std::mt19937& random, size_t numOperands)
+	{
+		std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+		std::vector<float> values(numOperands * 16);
+		for (auto& value : values) {
+			value = distribution(random);
+		}
+		return values;
+	}
+
+	// Reinterprets operand i of the input data as a matrix, vector or quaternion
+	template <typename T>
+	T& operand(std::vector<float>& values, size_t i)
+	{
+		return *reinterpret_cast<T*>(values.data() + i * 16);
+	}
+
+	bool isBitIdentical(const void* a, const void* b, size_t numBytes)
+	{
+		return memcmp(a, b, numBytes) == 0;
+	}
+
+	struct KernelCheck
+	{
+		const char* name;
+		int numMismatches;
+	};
+
+	// Compares SIMD and scalar kernels on the same inputs, operands a and b of every check come from two input arrays
+	std::vector<KernelCheck> checkKernels(std::vector<float>& a, std::vector<float>& b, size_t numInputs)
+	{
+		KernelCheck mul = { "mat4x4_mul", 0 };
+		KernelCheck mulAliased = { "mat4x4_mul (aliased)", 0 };
+		KernelCheck mulVec4 = { "mat4x4_mul_vec4", 0 };
+		KernelCheck transpose = { "mat4x4_transpose", 0 };
+		KernelCheck invert = { "mat4x4_invert", 0 };
+		KernelCheck quatMul = { "quat_mul", 0 };
+
+		for (size_t i = 0; i < numInputs; i++)
+		{
+			auto& A = operand<scalar::mat4x4>(a, i);
+			auto& B = operand<scalar::mat4x4>(b, i);
+			scalar::mat4x4 expected, actual;
+
+			scalar::mat4x4_mul(expected, A, B);
+			simd::mat4x4_mul(actual, A, B);
+			mul.numMismatches += isBitIdentical(expected, actual, sizeof(expected)) ? 0 : 1;
+
+			// Output is the left operand, kernels have to read all inputs before writing
+			memcpy(actual, A, sizeof(actual));
+			simd::mat4x4_mul(actual, actual, B);
+			mulAliased.numMismatches += isBitIdentical(expected, actual, sizeof(expected)) ? 0 : 1;
+
+			scalar::vec4 expectedVec4, actualVec4;
+			scalar::mat4x4_mul_vec4(expectedVec4, A, B[0]);
+			simd::mat4x4_mul_vec4(actualVec4, A, B[0]);
+			mulVec4.numMismatches += isBitIdentical(expectedVec4, actualVec4, sizeof(expectedVec4)) ? 0 : 1;
+
+			scalar::mat4x4_transpose(expected, A);
+			simd::mat4x4_transpose(actual, A);
+			transpose.numMismatches += isBitIdentical(expected, actual, sizeof(expected)) ? 0 : 1;
+
+			scalar::mat4x4_invert(expected, A);
+			simd::mat4x4_invert(actual, A);
+			invert.numMismatches += isBitIdentical(expected, actual, sizeof(expected)) ? 0 : 1;
+
+			scalar::quat expectedQuat, actualQuat;
+			scalar::quat_mul(expectedQuat, A[0], B[0]);
+			simd::quat_mul(actualQuat, A[0], B[0]);
+			quatMul.numMismatches += isBitIdentical(expectedQuat, actualQuat, sizeof(expectedQuat)) ? 0 : 1;
+		}
+
+		return { mul, mulAliased, mulVec4, transpose, invert, quatMul };
+	}
+
+	// Runs operation over all inputs for given number of rounds, returns operations per second
+	template <typename Operation>
+	double measure(size_t numInputs, int numRounds, Operation operation)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (auto round = 0; round < numRounds; round++)
+		{
+			for (size_t i = 0; i < numInputs; i++) {
+				operation(i);
+			}
+		}
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+		return double(numInputs) * numRounds / seconds.count();
+	}
+
+	volatile float sink; // Receives results, so that the compiler cannot drop the measured work
+
+	typedef void (*BenchOperation)(std::vector<float>&, std::vector<float>&, size_t);
+
+	void reportSpeed(const char* name, std::vector<float>& inputs, BenchOperation simdOperation, BenchOperation scalarOperation)
+	{
+		std::vector<float> outputs(inputs.size());
+		const auto simdSpeed = measure(NUM_BENCH_INPUTS, NUM_BENCH_ROUNDS, [&](size_t i) { simdOperation(inputs, outputs, i); });
+		sink = sink + outputs[0] + outputs[outputs.size() - 1];
+		const auto scalarSpeed = measure(NUM_BENCH_INPUTS, NUM_BENCH_ROUNDS, [&](size_t i) { scalarOperation(inputs, outputs, i); });
+		sink = sink + outputs[0] + outputs[outputs.size() - 1];
+		printf("%-20s %10.1f M/s %10.1f M/s %8.2fx\n", name, simdSpeed * 1e-6, scalarSpeed * 1e-6, simdSpeed / scalarSpeed);
+	}
+
+	// Operations read input operand i (and its successor) and write output operand i, linmath.h takes no const operands
+	template <typename Mat4x4, void (*Mul)(Mat4x4, Mat4x4, Mat4x4)>
+	void benchMul(std::vector<float>& inputs, std::vector<float>& outputs, size_t i)
+	{
+		Mul(operand<Mat4x4>(outputs, i), operand<Mat4x4>(inputs, i), operand<Mat4x4>(inputs, (i + 1) % NUM_BENCH_INPUTS));
+	}
+
+	template <typename Mat4x4, typename Vec4, void (*MulVec4)(Vec4, Mat4x4, Vec4)>
+	void benchMulVec4(std::vector<float>& inputs, std::vector<float>& outputs, size_t i)
+	{
+		MulVec4(operand<Mat4x4>(outputs, i)[0], operand<Mat4x4>(inputs, i), operand<Mat4x4>(inputs, (i + 1) % NUM_BENCH_INPUTS)[0]);
+	}
+
+	template <typename Mat4x4, void (*Unary)(Mat4x4, Mat4x4)>
+	void benchUnary(std::vector<float>& inputs, std::vector<float>& outputs, size_t i)
+	{
+		Unary(operand<Mat4x4>(outputs, i), operand<Mat4x4>(inputs, i));
+	}
+
+	template <typename Quat, void (*QuatMul)(Quat, Quat, Quat)>
+	void benchQuatMul(std::vector<float>& inputs, std::vector<float>& outputs, size_t i)
+	{
+		QuatMul(operand<Quat>(outputs, i), operand<Quat>(inputs, i), operand<Quat>(inputs, (i + 1) % NUM_BENCH_INPUTS));
+	}
+
+} // namespace
+
+int main()
+{
+	std::mt19937 random(2024);
+	printf("SIMD kernels: %s\n\n", simd::KERNELS);
+
+	auto a = makeInputs(random, NUM_CHECK_INPUTS);
+	auto b = makeInputs(random, NUM_CHECK_INPUTS);
+	auto isIdentical = true;
+	printf("Bit exactness against LINMATH_NO_SIMD on %d random inputs\n", NUM_CHECK_INPUTS);
+	for (const auto& check : checkKernels(a, b, NUM_CHECK_INPUTS))
+	{
+		printf("%-20s %s (%d mismatches)\n", check.name, check.numMismatches == 0 ? "identical" : "DIFFERS", check.numMismatches);
+		isIdentical = isIdentical && check.numMismatches == 0;
+	}
+	a.clear();
+	b.clear();
+
+	auto inputs = makeInputs(random, NUM_BENCH_INPUTS);
+	printf("\n%-20s %14s %14s %9s\n", "Operations per second", "SIMD", "scalar", "speedup");
+	reportSpeed("mat4x4_mul", inputs, benchMul<simd::mat4x4, simd::mat4x4_mul>, benchMul<scalar::mat4x4, scalar::mat4x4_mul>);
+	reportSpeed("mat4x4_mul_vec4", inputs, benchMulVec4<simd::mat4x4, simd::vec4, simd::mat4x4_mul_vec4>,
+		benchMulVec4<scalar::mat4x4, scalar::vec4, scalar::mat4x4_mul_vec4>);
+	reportSpeed("mat4x4_transpose", inputs, benchUnary<simd::mat4x4, simd::mat4x4_transpose>,
+		benchUnary<scalar::mat4x4, scalar::mat4x4_transpose>);
+	reportSpeed("mat4x4_invert", inputs, benchUnary<simd::mat4x4, simd::mat4x4_invert>,
+		benchUnary<scalar::mat4x4, scalar::mat4x4_invert>);
+	reportSpeed("quat_mul", inputs, benchQuatMul<simd::quat, simd::quat_mul>, benchQuatMul<scalar::quat, scalar::quat_mul>);
+
+	return isIdentical ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+/**
+* Standalone benchmark of vertex fetch with planar and interleaved StaticMesh3D vertex layouts. It builds
+* the same high-slice Cylinder in both layouts in a hidden GLFW window and:
+* - renders both into an offscreen framebuffer and compares the pixels, the layout must not change the image,
+* - then times NUM_ROUNDS batches of NUM_DRAWS_PER_QUERY draws of every layout, both with a GL_TIME_ELAPSED query
+*   and by wall clock between two glFinish calls, and reports the best and median time of a batch and vertices per
+*   second of the best one. Software renderers like llvmpipe leave vertex processing out of timer queries, then only
+*   the glFinish times are meaningful. During batches
+*   the cylinder is moved out of the clip volume, every vertex is still fetched and shaded, but nothing is rasterized.
+*   GL_RASTERIZER_DISCARD is not used, drivers may skip the vertex shader entirely with it.
+* Batches of the two layouts alternate, so that clock changes of the GPU affect both of them alike.
+*
+* Build from the repository root in the x86 (Win32) developer prompt, with the include and library directories of the project:
+*   cl /O2 /EHsc /IProject tools\vertex_fetch_bench.cpp Project\cylinder.cpp Project\staticMesh3D.cpp Project\boundingVolumes.cpp
+*     Project\vertexBufferObject.cpp Project\glStateCache.cpp Project\glad.c glfw3.lib opengl32.lib
+* Exit code is 1, if the context cannot be created, the layouts render different images or no pixels at all.
+*/
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Project
+#include "cylinder.h"
+#include "glStateCache.h"
+
+using namespace static_meshes_3D;
+
+namespace {
+
+	const int NUM_SLICES = 65536; // Cylinder has 4 * NUM_SLICES + 6 vertices, 8 MB in either layout
+	const int NUM_DRAWS_PER_QUERY = 20;
+	const int NUM_ROUNDS = 15;
+	const int FRAMEBUFFER_SIZE = 64;
+
+	const char* VERTEX_SHADER_SOURCE = R"(
+		#version 330 core
+		layout(location = 0) in vec3 position;
+		layout(location = 1) in vec2 textureCoordinate;
+		layout(location = 2) in vec3 normal;
+		out vec3 color;
+		uniform float clipOffset;
+		void main()
+		{
+			// Tilted towards the viewer, so that the side and the top cover are visible
+			vec3 tilted = vec3(position.x, position.y * 0.8 + position.z * 0.6, position.z * 0.8 - position.y * 0.6);
+			gl_Position = vec4(tilted.x * 0.4 + clipOffset, tilted.y * 0.4, tilted.z * 0.1, 1.0);
+			color = vec3(textureCoordinate, 0.5 + 0.25 * normal.x + 0.25 * normal.y);
+		}
+	)";
+
+	const char* FRAGMENT_SHADER_SOURCE = R"(
+		#version 330 core
+		in vec3 color;
+		out vec4 fragmentColor;
+		void main()
+		{
+			fragmentColor = vec4(color, 1.0);
+		}
+	)";
+
+	GLuint compileShader(GLenum type, const char* source)
+	{
+		const auto shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint isCompiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+		if (isCompiled == GL_FALSE)
+		{
+			char log[1024];
+			glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+			printf("Shader compilation failed: %s\n", log);
+		}
+		return shader;
+	}
+
+	GLuint createProgram()
+	{
+		const auto vertexShader = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER_SOURCE);
+		const auto fragmentShader = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER_SOURCE);
+		const auto program = glCreateProgram();
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		glLinkProgram(program);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		GLint isLinked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+		return isLinked == GL_TRUE ? program : 0;
+	}
+
+	// Renders the cylinder once into the bound framebuffer and reads the image back
+	std::vector<unsigned char> renderImage(const Cylinder& cylinder)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+		cylinder.render();
+
+		std::vector<unsigned char> pixels(FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE * 4);
+		glReadPixels(0, 0, FRAMEBUFFER_SIZE, FRAMEBUFFER_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		return pixels;
+	}
+
+	int countCoveredPixels(const std::vector<unsigned char>& pixels)
+	{
+		auto result = 0;
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			result += pixels[i] != 0 || pixels[i + 1] != 0 || pixels[i + 2] != 0 ? 1 : 0;
+		}
+		return result;
+	}
+
+	struct BatchTime
+	{
+		double queryNanoseconds; // Time reported by the GL_TIME_ELAPSED query
+		double finishNanoseconds; // Wall clock time between glFinish before and after the draws
+	};
+
+	// Times one batch of draws, waits for the query result
+	BatchTime measureBatch(const Cylinder& cylinder, GLuint query)
+	{
+		glFinish();
+		const auto start = std::chrono::steady_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (auto i = 0; i < NUM_DRAWS_PER_QUERY; i++) {
+			cylinder.render();
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+		glFinish();
+		const std::chrono::duration<double, std::nano> finishNanoseconds = std::chrono::steady_clock::now() - start;
+
+		GLuint64 queryNanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &queryNanoseconds);
+		return { double(queryNanoseconds), finishNanoseconds.count() };
+	}
+
+	struct TimeSummary
+	{
+		double best; // Nanoseconds of the fastest batch
+		double median; // Nanoseconds of the median batch
+	};
+
+	TimeSummary summarize(const std::vector<BatchTime>& batchTimes, double BatchTime::*time)
+	{
+		std::vector<double> times;
+		for (const auto& batchTime : batchTimes) {
+			times.push_back(batchTime.*time);
+		}
+		std::sort(times.begin(), times.end());
+		return { times.front(), times[times.size() / 2] };
+	}
+
+	void reportTimes(const char* name, const std::vector<BatchTime>& planarTimes, const std::vector<BatchTime>& interleavedTimes,
+		double BatchTime::*time)
+	{
+		const auto numVerticesPerBatch = double(4 * NUM_SLICES + 6) * NUM_DRAWS_PER_QUERY;
+		const auto planar = summarize(planarTimes, time);
+		const auto interleaved = summarize(interleavedTimes, time);
+		printf("%s\n", name);
+		printf("  %-12s %10.3f ms %10.3f ms %10.1f M/s\n", "planar", planar.best * 1e-6, planar.median * 1e-6, numVerticesPerBatch / planar.best * 1e3);
+		printf("  %-12s %10.3f ms %10.3f ms %10.1f M/s\n", "interleaved", interleaved.best * 1e-6, interleaved.median * 1e-6,
+			numVerticesPerBatch / interleaved.best * 1e3);
+		printf("  interleaved speedup %.2fx (best), %.2fx (median)\n", planar.best / interleaved.best, planar.median / interleaved.median);
+	}
+
+} // namespace
+
+int main()
+{
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	auto window = glfwCreateWindow(FRAMEBUFFER_SIZE, FRAMEBUFFER_SIZE, "Vertex fetch benchmark", nullptr, nullptr);
+	if (window == nullptr)
+	{
+		printf("Failure to create GLFW window.\n");
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		printf("Failed to initialize GLAD.\n");
+		glfwTerminate();
+		return 1;
+	}
+	printf("Renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	// Own framebuffer, so that neither the hidden window nor the swap interval take part
+	GLuint renderbuffer = 0, framebuffer = 0;
+	glGenRenderbuffers(1, &renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, FRAMEBUFFER_SIZE, FRAMEBUFFER_SIZE);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+	glViewport(0, 0, FRAMEBUFFER_SIZE, FRAMEBUFFER_SIZE);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+	const auto program = createProgram();
+	if (program == 0 || glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Failed to create shader program or framebuffer.\n");
+		glfwTerminate();
+		return 1;
+	}
+	GLStateCache::getInstance().useProgram(program);
+
+	// Scope destroys both meshes while the context is still current
+	auto isCorrect = false;
+	{
+		const Cylinder planar(1.0f, NUM_SLICES, 1.0f, true, true, true, VertexLayout::Planar);
+		const Cylinder interleaved(1.0f, NUM_SLICES, 1.0f, true, true, true, VertexLayout::Interleaved);
+
+		const auto planarImage = renderImage(planar);
+		const auto numCoveredPixels = countCoveredPixels(planarImage);
+		const auto isIdentical = planarImage == renderImage(interleaved);
+		isCorrect = isIdentical && numCoveredPixels > 0;
+		printf("Cylinder with %d slices, %d vertices, %d draws per batch\n", NUM_SLICES, 4 * NUM_SLICES + 6, NUM_DRAWS_PER_QUERY);
+		printf("Rendered images %s, %d of %d pixels covered\n\n", isIdentical ? "identical" : "DIFFER", numCoveredPixels,
+			FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE);
+
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		// Whole cylinder lies right of the clip volume, its primitives are clipped right after the vertex shader
+		glUniform1f(glGetUniformLocation(program, "clipOffset"), 3.0f);
+
+		// First batches only warm up caches and let the driver finish lazy uploads
+		measureBatch(planar, query);
+		measureBatch(interleaved, query);
+
+		std::vector<BatchTime> planarTimes, interleavedTimes;
+		for (auto round = 0; round < NUM_ROUNDS; round++)
+		{
+			const auto isPlanarFirst = round % 2 == 0;
+			if (isPlanarFirst) {
+				planarTimes.push_back(measureBatch(planar, query));
+			}
+			interleavedTimes.push_back(measureBatch(interleaved, query));
+			if (!isPlanarFirst) {
+				planarTimes.push_back(measureBatch(planar, query));
+			}
+		}
+		glDeleteQueries(1, &query);
+
+		printf("%-14s %13s %13s %13s\n", "Batch time", "best", "median", "vertices");
+		reportTimes("GL_TIME_ELAPSED", planarTimes, interleavedTimes, &BatchTime::queryNanoseconds);
+		reportTimes("glFinish", planarTimes, interleavedTimes, &BatchTime::finishNanoseconds);
+	}
+
+	GLStateCache::getInstance().onProgramDeleted(program);
+	glDeleteProgram(program);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &renderbuffer);
+	glfwTerminate();
+	return isCorrect ? 0 : 1;
+}